@@ -3,31 +3,123 @@
 #include <cmath>
 #include <sstream>
 #include <iomanip>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <memory>
+#include <random>
+#include <fstream>
+#include <cstring>
+#include <cctype>
+
+// Graph snapshots are mapped into memory rather than read.
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Hardware counters for the query statistics are read through perf_event_open, which only Linux has.
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#endif
+
+// The bitboard engine has an AVX2 version, chosen at run time, when compiled by g++ for x86.
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define BITBOARD_AVX2 1
+#endif
 
 using std::queue;
 
 /*==== Private Functions ====*/
 
+static const char* mapFile(const string& path, size_t& size)
+{
+    /*
+    Maps the whole file at path into memory, read only, and sets size to its length.  Returns nullptr if the file
+    does not exist, is empty or cannot be mapped.
+    */
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    const char* data = nullptr;
+    LARGE_INTEGER fileSize;
+
+    if (file == INVALID_HANDLE_VALUE)
+        return nullptr;
+
+    if (GetFileSizeEx(file, &fileSize) && fileSize.QuadPart > 0)
+    {
+        // The view keeps the mapping alive, so both handles can be closed right away.
+        HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+
+        if (mapping != nullptr)
+        {
+            data = (const char*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+            size = fileSize.QuadPart;
+            CloseHandle(mapping);
+        }
+    }
+
+    CloseHandle(file);
+    return data;
+#else
+    int fd = open(path.c_str(), O_RDONLY);
+    struct stat info;
+    void* data = MAP_FAILED;
+
+    if (fd < 0)
+        return nullptr;
+
+    if (fstat(fd, &info) == 0 && info.st_size > 0)
+    {
+        size = info.st_size;
+        data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+
+    close(fd);
+    return data == MAP_FAILED ? nullptr : (const char*)data;
+#endif
+}
+
+static void unmapFile(const char* data, size_t size)
+{
+    /*
+    Unmaps a file mapped by mapFile.
+    */
+#ifdef _WIN32
+    UnmapViewOfFile(data);
+#else
+    munmap((void*)data, size);
+#endif
+}
+
 Board::Tile::Tile()
 {
     /*
-    Tile constructor.  Sets the fill color, size, outline color and thickness.
+    Tile constructor.  The tile's quad in the board's vertex array is set up by makeGraphs.
     */
-    tile.setFillColor(sf::Color::Black);
-    tile.setSize(sf::Vector2f(xSize, ySize));
-    tile.setOutlineColor(sf::Color::Red);
-    tile.setOutlineThickness(borderThickness);
-    isSource = false;
-    isDest = false;
-    isObst = false;
+    quad = nullptr;
+    redraw = nullptr;
 }
 
 void Board::Tile::setTileColor(sf::Color c)
 {
     /*
-    Sets the fill color for the tile.
+    Sets the fill color for the tile, by coloring the four corners of its quad, and asks the board for a redraw.
     */
-    tile.setFillColor(c);
+    for (int k = 0; k < 4; k++)
+        quad[k].color = c;
+
+    // The window only redraws when something has changed.
+    *redraw = true;
 }
 
 void Board::makeGraphs()
@@ -35,34 +127,207 @@ void Board::makeGraphs()
     /*
     Constructs both graph implementations: map and linked list (LL).
     */
+    makeTiles();
+
+    // Every tile is drawn as one quad of a single vertex array, so the whole grid is one draw call.  The red lines
+    // between tiles are one more quad behind them, showing through the gaps.
+    makeVertices();
+
+    // For each tile/node, create the edges to nearest neighbors for the map, and the nearest neighbor pointers for the LL.
+    for (int i = 0; i < tilesY; i++)
+    {
+        for (int j = 0; j < tilesX; j++)
+        {
+            insertEdges(i, j);
+            setLLPointers(i, j);
+        }
+    }
+
+    // Pack the finished map implementation into flat arrays for the CSR implementation, and build the rest of the
+    // search state from it.
+    makeFlatGraph();
+    makeSearchState();
+}
+
+void Board::makeTiles()
+{
+    /*
+    Allocates the tiles and nodes, and fills posToTile, indexToTile and graphMap, with an empty set of neighbors for
+    every tile.  Makes the node at {0, 0} the LL head node.
+    */
     int indexNum = 0; // Index of each tile. 0 to (tilesX - 1) for tiles in row 0, tilesX to 2*tilesX - 1 for row 1, etc.
 
+    // All tiles and all nodes live in two blocks, allocated once, in grid order.  The blocks are never grown after
+    // this, so pointers to tiles and nodes stay valid.
+    tilePool.reserve(tilesX * tilesY);
+    nodePool.reserve(tilesX * tilesY);
+
     // At {i, j} grid position, contruct a tile and a node, set its position.  Make node at {0, 0} the LL head node.
     for (int i = 0; i < tilesY; i++)
     {
         for (int j = 0; j < tilesX; j++)
         {
-            Tile* tile = new Tile();
+            tilePool.emplace_back();
+            Tile* tile = &tilePool.back();
             tile->index = indexNum++;
-            Node* node = new Node(tile);
+            nodePool.emplace_back(tile);
+            Node* node = &nodePool.back();
             posToTile[std::make_pair(i, j)] = std::make_pair(tile, node);
-            tile->tile.setPosition(sf::Vector2f(borderThickness + j * (xSize + 2 * borderThickness), borderThickness + i * (ySize + 2 * borderThickness)));
             graphMap[tile] = {};
+            indexToTile.push_back(tile);
 
             if (i == 0 && j == 0)
                 head = node;
         }
     }
+}
 
-    // For each tile/node, create the edges to nearest neighbors for the map, and the nearest neighbor pointers for the LL.
-    for (int i = 0; i < tilesY; i++)
+void Board::makeSearchState()
+{
+    /*
+    Builds the state the engines keep beside the graphs.  Runs once csrOffsets, csrTargets and obstacleMask exist.
+    */
+
+    // Lay the express lanes over the finished linked list.
+    makeExpressLanes();
+
+    // Mark every tile as free in the bitboard implementation, and surround the obstacle flags with a sentinel ring
+    // for the grid engines.
+    makeBitboard();
+    makePaddedGrid();
+
+    // Give every tile a random 64-bit key for hashing the obstacle layout.  The seed is fixed so that hashes are
+    // the same from run to run.
+    std::mt19937_64 rng(20240601);
+    tileKeys.resize(indexToTile.size());
+
+    for (uint64_t& key: tileKeys)
+        key = rng();
+
+    obstacleHash = 0;
+
+    // Every tile starts on plain ground.
+    terrainCost.assign(indexToTile.size(), 1);
+    terrainHash = 0;
+    heavyTiles = 0;
+    terrainTiles = 0;
+    dialBuckets.assign(maxTerrainCost + 1, {});
+
+    // Every cluster of the hierarchical engine is built on its first query.
+    hpaClusters.assign(hpaClustersX * hpaClustersY, HpaCluster());
+    hpaNodeSlot.assign(indexToTile.size(), -1);
+}
+
+bool Board::loadSnapshot(const string& path)
+{
+    /*
+    Builds the graphs from a snapshot written by saveSnapshot, in place of makeGraphs.  The file is mapped into memory
+    and used as it is: the CSR arrays are copied straight out of it, and the map and linked list implementations are
+    filled from the CSR adjacency in index order, so every insert goes at the end and no posToTile lookups are made.
+    Returns false, leaving the board untouched, if the file is missing, was written for another format version or
+    board size, or its adjacency is not a set of edges between neighboring tiles.
+    */
+    size_t size = 0;
+    const char* data = mapFile(path, size);
+
+    if (data == nullptr)
+        return false;
+
+    SnapshotHeader header;
+    bool valid = size >= sizeof(header);
+
+    if (valid)
     {
-        for (int j = 0; j < tilesX; j++)
+        memcpy(&header, data, sizeof(header));
+        valid = memcmp(header.magic, "BFSG", 4) == 0 && header.version == snapshotVersion && header.width == tilesX && header.height == tilesY
+            && header.vertices == tilesX * tilesY
+            && size == sizeof(header) + (uint64_t(header.vertices) + 1 + header.edges) * sizeof(int) + header.vertices;
+    }
+
+    int numVertices = valid ? header.vertices : 0;
+    const int* offsets = (const int*)(data + sizeof(header));
+    const int* targets = offsets + numVertices + 1;
+    const char* obstacleLayer = (const char*)(targets + (valid ? header.edges : 0));
+
+    valid = valid && offsets[0] == 0 && offsets[numVertices] == (int)header.edges;
+
+    for (int u = 0; valid && u < numVertices; u++)
+    {
+        valid = offsets[u] <= offsets[u + 1];
+
+        for (int e = offsets[u]; valid && e < offsets[u + 1]; e++)
         {
-            insertEdges(i, j);
-            setLLPointers(i, j);
+            int v = targets[e];
+            valid = v >= 0 && v < numVertices && v != u && std::abs(v / tilesX - u / tilesX) <= 1 && std::abs(v % tilesX - u % tilesX) <= 1;
+        }
+    }
+
+    if (!valid)
+    {
+        unmapFile(data, size);
+        return false;
+    }
+
+    makeTiles();
+    csrOffsets.assign(offsets, offsets + numVertices + 1);
+    csrTargets.assign(targets, targets + header.edges);
+
+    // Node pointer that leads to the neighbor at row offset di and column offset dj, at [(di + 1) * 3 + dj + 1].
+    Node* Node::* const links[9] = {&Node::topLeft, &Node::up, &Node::topRight, &Node::left, nullptr, &Node::right, &Node::botLeft, &Node::down, &Node::botRight};
+
+    // Tiles live in one block in index order, so graphMap lists them in index order too.
+    auto entry = graphMap.begin();
+
+    for (int u = 0; u < numVertices; u++, ++entry)
+    {
+        for (int e = offsets[u]; e < offsets[u + 1]; e++)
+        {
+            int v = targets[e];
+            entry->second.emplace_hint(entry->second.end(), indexToTile[v]);
+            nodePool[u].*links[(v / tilesX - u / tilesX + 1) * 3 + v % tilesX - u % tilesX + 1] = &nodePool[v];
         }
     }
+
+    makeVertices();
+    obstacleMask.assign(numVertices, 0);
+    makeSearchState();
+    setObstacleLayout(vector<char>(obstacleLayer, obstacleLayer + numVertices));
+    unmapFile(data, size);
+
+    return true;
+}
+
+void Board::makeVertices()
+{
+    /*
+    Builds tileVertices, with the quad of the tile at index u at vertices 4u to 4u + 3, points each tile at its quad
+    and at needsRedraw, and colors it black.  Tiles keep a pointer into tileVertices, so it is never resized after this.  Also builds
+    gridBackdrop, the red quad behind the tiles that shows through the gaps between them as grid lines.
+    */
+    tileVertices.setPrimitiveType(sf::Quads);
+    tileVertices.resize(4 * indexToTile.size());
+
+    for (Tile* tile: indexToTile)
+    {
+        float x = borderThickness + tile->index % tilesX * (xSize + 2 * borderThickness);
+        float y = borderThickness + tile->index / tilesX * (ySize + 2 * borderThickness);
+        tile->quad = &tileVertices[4 * tile->index];
+        tile->redraw = &needsRedraw;
+        tile->quad[0].position = sf::Vector2f(x, y);
+        tile->quad[1].position = sf::Vector2f(x + xSize, y);
+        tile->quad[2].position = sf::Vector2f(x + xSize, y + ySize);
+        tile->quad[3].position = sf::Vector2f(x, y + ySize);
+        tile->setTileColor(sf::Color::Black);
+    }
+
+    float width = tilesX * (xSize + 2 * borderThickness);
+    float height = tilesY * (ySize + 2 * borderThickness);
+    gridBackdrop.setPrimitiveType(sf::Quads);
+    gridBackdrop.resize(4);
+    gridBackdrop[0] = sf::Vertex(sf::Vector2f(0.f, 0.f), sf::Color::Red);
+    gridBackdrop[1] = sf::Vertex(sf::Vector2f(width, 0.f), sf::Color::Red);
+    gridBackdrop[2] = sf::Vertex(sf::Vector2f(width, height), sf::Color::Red);
+    gridBackdrop[3] = sf::Vertex(sf::Vector2f(0.f, height), sf::Color::Red);
 }
 
 void Board::insertEdges(int i, int j)
@@ -229,14 +494,200 @@ void Board::setLLPointers(int i, int j)
     }
 }
 
+void Board::makeFlatGraph()
+{
+    /*
+    Constructs the flat, compressed sparse row (CSR) implementation from graphMap.  The neighbors of the vertex at
+    index u are stored in csrTargets from position csrOffsets[u] up to (but not including) csrOffsets[u + 1].
+    Neighbors are stored in increasing index order so that the inner loop of the search walks memory forwards.
+    */
+    int numVertices = indexToTile.size();
+    csrOffsets.assign(numVertices + 1, 0);
+    csrTargets.clear();
+    csrTargets.reserve(8 * numVertices);
+    obstacleMask.assign(numVertices, 0);
+
+    for (int u = 0; u < numVertices; u++)
+    {
+        csrOffsets[u] = csrTargets.size();
+        vector<int> adj;
+
+        for (Tile* n: graphMap[indexToTile[u]])
+            adj.push_back(n->index);
+
+        std::sort(adj.begin(), adj.end());
+        csrTargets.insert(csrTargets.end(), adj.begin(), adj.end());
+    }
+
+    csrOffsets[numVertices] = csrTargets.size();
+}
+
+void Board::makeBitboard()
+{
+    /*
+    Sets the bit of every tile in freeBits.  The padding words and rows around the board stay zero, so a tile on
+    the border never sees a free neighbor outside the board.
+    */
+    freeBits.assign(bitBoardWords, 0);
+
+    for (int i = 0; i < tilesY; i++)
+    {
+        for (int j = 0; j < tilesX; j++)
+            freeBits[(i + 1) * bitStride + 1 + j / 64] |= uint64_t(1) << (j % 64);
+    }
+}
+
+void Board::setObstacle(Tile* t, bool isObstacle)
+{
+    /*
+    Marks (or unmarks) tile t as an obstacle.  Every change to a single tile goes through here so that the
+    obstacles set, the flat obstacleMask used by the CSR implementation and the freeBits bitboard never disagree.
+    Whole layouts are replaced by setObstacleLayout instead.
+    */
+    // Only called when the state changes, so flipping the tile's key in or out of the hash is always right.
+    obstacleMask[t->index] = isObstacle;
+    paddedBlocked[(t->index / tilesX + 1) * (tilesX + 2) + t->index % tilesX + 1] = isObstacle;
+    obstacleHash ^= tileKeys[t->index];
+    int i = t->index / tilesX;
+    int j = t->index % tilesX;
+    uint64_t bit = uint64_t(1) << (j % 64);
+
+    if (isObstacle)
+        freeBits[(i + 1) * bitStride + 1 + j / 64] &= ~bit;
+
+    else
+        freeBits[(i + 1) * bitStride + 1 + j / 64] |= bit;
+
+    // The incremental engine repairs its kept search around this tile on its next run.
+    if (incSource != -1)
+        incChanged.push_back(t->index);
+
+    // The hierarchical engine rebuilds the clusters this tile belongs to before its next query.
+    hpaMarkDirty(t->index);
+
+    // The distance field may no longer be right anywhere, so it is built again when next needed.
+    if (fieldSource != -1)
+        clearDistanceField();
+
+    if (isObstacle)
+    {
+        t->setTileColor(sf::Color::Magenta);
+        obstacles.insert(t);
+    }
+
+    else
+    {
+        t->setTileColor(restingColor(t->index));
+        obstacles.erase(t);
+    }
+}
+
+void Board::setObstacleLayout(const vector<char>& blocked)
+{
+    /*
+    Replaces the obstacle layout with blocked, which is nonzero for each tile that is an obstacle, in one pass over
+    the board rather than one setObstacle call per tile.  Everything setObstacle keeps in sync is rebuilt at once,
+    and the obstacles set is filled in index order, so every insert goes at the end.  The incremental and hierarchical
+    engines start over on their next query.  The source and destination tiles never become obstacles.
+    */
+    clearShortestPath();
+
+    if (fieldSource != -1)
+        clearDistanceField();
+
+    obstacles.clear();
+    obstacleHash = 0;
+    makeBitboard();
+
+    for (int u = 0; u < indexToTile.size(); u++)
+    {
+        Tile* t = indexToTile[u];
+        char isObstacle = blocked[u] && t != source && t != destin;
+
+        if (isObstacle != obstacleMask[u])
+            t->setTileColor(isObstacle ? sf::Color::Magenta : restingColor(u));
+
+        obstacleMask[u] = isObstacle;
+
+        if (isObstacle)
+        {
+            obstacles.emplace_hint(obstacles.end(), t);
+            obstacleHash ^= tileKeys[u];
+            freeBits[(u / tilesX + 1) * bitStride + 1 + (u % tilesX) / 64] &= ~(uint64_t(1) << (u % tilesX % 64));
+        }
+    }
+
+    makePaddedGrid();
+    incSource = -1;
+
+    for (HpaCluster& cluster: hpaClusters)
+        cluster.dirty = true;
+}
+
+string Board::engineName(GraphType type)
+{
+    /*
+    Returns the name of the engine as it appears in the side panel.
+    */
+    switch (type)
+    {
+        case GraphType::LinkedList:
+            return "Linked list";
+        case GraphType::Map:
+            return "Map";
+        case GraphType::Flat:
+            return "Flat (CSR)";
+        case GraphType::Bitboard:
+            return "Bitboard";
+        case GraphType::DirectionOptimizing:
+            return "Direction-optimizing";
+        case GraphType::Parallel:
+            return "Parallel";
+        case GraphType::Incremental:
+            return "Incremental (LPA*)";
+        case GraphType::DistanceField:
+            return "Distance field";
+        case GraphType::JumpPoint:
+            return "Jump point search";
+        case GraphType::AStar:
+            return "A* (Chebyshev)";
+        case GraphType::Hierarchical:
+            return "Hierarchical (HPA*)";
+        case GraphType::Specialized:
+            return "Grid (compile-time)";
+        case GraphType::RuntimeGrid:
+            return "Grid (run-time)";
+        case GraphType::Weighted:
+            return "Weighted (Dial)";
+        default:
+            return "";
+    }
+}
+
+GraphType Board::engineClicked(sf::Vector2i position)
+{
+    /*
+    Returns the engine whose text button contains the mouse position, or GraphType::None if no text button does.
+    */
+    for (auto& entry: engineText)
+    {
+        if (entry.second.getGlobalBounds().contains(position.x, position.y))
+            return entry.first;
+    }
+
+    return GraphType::None;
+}
+
 void Board::displayBoard(sf::RenderWindow& window)
 {
     /*
-    Display the grid of tiles using the window.draw() SFML function.
+    Display the grid of tiles using the window.draw() SFML function.  The tiles are a single vertex array, so this
+    is one draw call (two with the grid lines) however many tiles there are.
     */
-    map<Tile*, set<Tile*>>::iterator iter = graphMap.begin();
-	for (; iter != graphMap.end(); ++iter)
-        window.draw(iter->first->tile);
+    if (gridLines)
+        window.draw(gridBackdrop);
+
+    window.draw(tileVertices);
     
     // Display the text showing instructions and results in the right margin of the window.
     displayText(window);
@@ -306,15 +757,9 @@ void Board::displayText(sf::RenderWindow& window)
     text6.setCharacterSize(20);
     text6.setFillColor(sf::Color::White);
     
-    if (linkedListSelected)
-    {
-        text6.setString("Linked list selected");
-        window.draw(text6);
-    }
-
-    else if (mapSelected)
+    if (graphType != GraphType::None)
     {
-        text6.setString("Map selected");
+        text6.setString(engineName(graphType) + " selected");
         window.draw(text6);
     }
 
@@ -334,7 +779,7 @@ void Board::displayText(sf::RenderWindow& window)
 
     // Once user selects a starting and ending tile, and a graph type, this text will appear, instructing
     // user to click the Go button to find the shortest path.
-    if (source != nullptr && destin != nullptr && (mapSelected || linkedListSelected))
+    if (source != nullptr && destin != nullptr && graphType != GraphType::None)
     {
         text5.setFont(font);
         text5.setString("Go for shortest path");
@@ -409,8 +854,15 @@ void Board::displayText(sf::RenderWindow& window)
         stream << std::fixed << std::setprecision(2) << timeTaken;
         std::string s = stream.str();
 
+        // Engines that seek before searching show the two phases apart.
+        if (queryStats.seekMs > 0)
+            stream << " ms (seek " << queryStats.seekMs << ")";
+
+        else
+            stream << " ms";
+
         text10.setFont(font);
-        string message2 = stream.str() + " ms";
+        string message2 = stream.str();
         text10.setString(message2);
         text10.setPosition(sf::Vector2f(1715.f, 415.f));
         text10.setCharacterSize(20);
@@ -418,12 +870,22 @@ void Board::displayText(sf::RenderWindow& window)
         window.draw(text10);
     }
 
+    // This text always shows.  Says how long the constructor took to build the graphs or load them from the snapshot.
+    std::stringstream setupStream;
+    setupStream << (snapshotLoaded ? "Graphs loaded in " : "Graphs built in ") << std::fixed << std::setprecision(2) << setupDuration.count() << " ms";
+    text14.setFont(font);
+    text14.setString(setupStream.str());
+    text14.setPosition(sf::Vector2f(1715.f, 440.f));
+    text14.setCharacterSize(16);
+    text14.setFillColor(sf::Color::White);
+    window.draw(text14);
+
     // Displays when the Try Again button is clicked.
     if (tryAgainClicked)
     {
         text11.setFont(font);
         text11.setString("Click to try again");
-        text11.setPosition(sf::Vector2f(1715.f, 450.f));
+        text11.setPosition(sf::Vector2f(1715.f, 460.f));
         text11.setCharacterSize(20);
         text11.setFillColor(sf::Color::White);
         window.draw(text11);
@@ -431,100 +893,249 @@ void Board::displayText(sf::RenderWindow& window)
         // Displays the Try Again button.
         tryAgainTexture.loadFromFile("images/tryagain.jpg");
         tryAgainSprite.setTexture(tryAgainTexture);
-        tryAgainSprite.setPosition(sf::Vector2f(1765.f, 480.f));
+        tryAgainSprite.setPosition(sf::Vector2f(1765.f, 485.f));
         window.draw(tryAgainSprite);
     }
+
+    // This text always shows.  Switches the bidirectional mode on and off.
+    bidirectionalText.setFont(font);
+    bidirectionalText.setString(bidirectional ? "Bidirectional: on" : "Bidirectional: off");
+    bidirectionalText.setPosition(sf::Vector2f(1715.f, 634.f));
+    bidirectionalText.setCharacterSize(18);
+    bidirectionalText.setFillColor(bidirectional ? sf::Color::Yellow : sf::Color::White);
+    window.draw(bidirectionalText);
+
+    // This text always shows.  Switches the animated search on and off, and says how to cancel one that is running.
+    animateText.setFont(font);
+    animateText.setString(animation.active ? "Animating... (Esc cancels)" : animate ? "Animate: on" : "Animate: off");
+    animateText.setPosition(sf::Vector2f(1715.f, 590.f));
+    animateText.setCharacterSize(18);
+    animateText.setFillColor(animate ? sf::Color::Yellow : sf::Color::White);
+    window.draw(animateText);
+
+    // This text always shows.  Switches the heat map of the distance field on and off.
+    heatMapText.setFont(font);
+    heatMapText.setString(heatMap ? "Heat map: on" : "Heat map: off");
+    heatMapText.setPosition(sf::Vector2f(1715.f, 612.f));
+    heatMapText.setCharacterSize(18);
+    heatMapText.setFillColor(heatMap ? sf::Color::Yellow : sf::Color::White);
+    window.draw(heatMapText);
+
+    // This text always shows.  Steps the terrain brush through off and every cost; keys 0 to 9 pick a cost directly.
+    terrainText.setFont(font);
+    terrainText.setString(terrainBrush == -1 ? "Terrain brush: off" : "Terrain brush: " + std::to_string(terrainBrush));
+    terrainText.setPosition(sf::Vector2f(1715.f, 656.f));
+    terrainText.setCharacterSize(18);
+    terrainText.setFillColor(terrainBrush != -1 ? sf::Color::Yellow : sf::Color::White);
+    window.draw(terrainText);
+
+    // This text always shows.  Lists the engines that have no image button.  The selected engine is shown in yellow.
+    text12.setFont(font);
+    text12.setString("Other engines:");
+    text12.setPosition(sf::Vector2f(1715.f, 684.f));
+    text12.setCharacterSize(20);
+    text12.setFillColor(sf::Color::White);
+    window.draw(text12);
+
+    float y = 710.f;
+
+    for (auto& entry: engineText)
+    {
+        entry.second.setFont(font);
+        entry.second.setString(engineName(entry.first));
+        entry.second.setPosition(sf::Vector2f(1735.f, y));
+        entry.second.setCharacterSize(16);
+        entry.second.setFillColor(graphType == entry.first ? sf::Color::Yellow : sf::Color::White);
+        window.draw(entry.second);
+        y += 18.f;
+    }
+
+    // Extra result lines, such as the one-way and bidirectional comparison, show under the engine list after a run,
+    // or while a hover path of the distance field is shown.  The list and the lines are kept small so that even the
+    // longest run's six lines, hardware counters included, end above the bottom of the window.
+    if (shortestPath.size() > 0 || hoverIndex != -1)
+    {
+        y += 10.f;
+
+        for (const string& line: resultLines)
+        {
+            text13.setFont(font);
+            text13.setString(line);
+            text13.setPosition(sf::Vector2f(1715.f, y));
+            text13.setCharacterSize(14);
+            text13.setFillColor(sf::Color::White);
+            window.draw(text13);
+            y += 16.f;
+        }
+    }
+}
+
+void Board::beginSearch()
+{
+    /*
+    Starts a search in the search workspace.  The arrays are sized on first use and then kept, so searches that use
+    them allocate nothing.  Advancing workEpoch unmarks every tile at once; only when the counter wraps around, once
+    every four billion searches, is workVisited cleared.
+    */
+    if (workVisited.size() != indexToTile.size())
+    {
+        workQueue.assign(indexToTile.size(), 0);
+        workParent.assign(indexToTile.size(), -1);
+        workVisited.assign(indexToTile.size(), 0);
+        workEpoch = 0;
+    }
+
+    if (++workEpoch == 0)
+    {
+        std::fill(workVisited.begin(), workVisited.end(), 0);
+        workEpoch = 1;
+    }
+}
+
+void Board::releasePath(int* p)
+{
+    /*
+    Frees a p array returned by an engine or by cachedPath.  The workspace's workParent is owned by the board and
+    reused by the next search, so it is left alone.
+    */
+    if (p != workParent.data())
+        delete[] p;
 }
 
 int* Board::shortestPathGraph()
 {
     /*
-    Finds shortest path for the map implementation.
+    Finds shortest path for the map implementation.  The queue, parents and visited marks live in the board's
+    search workspace, so the search allocates nothing and does not clear an array per tile before it starts.
     */
 
     // Start the clock.
     auto start = high_resolution_clock::now();
 
-    // Total number of vertices, including the obstacles (for simplicity at the cost of extra memory used).
-    int numVertices = graphMap.size();
-    // Queue containing vertices that need to be visited.
-    queue<int> q;
-    // Create new boolean array of size numVertices saying whether tile at each index has been visited by algorithm.
-    bool* visited = new bool[numVertices] {false};
+    // Start a new search in the workspace: every tile becomes unvisited at once.
+    beginSearch();
+    // Queue containing vertices that need to be visited.  Each vertex is queued at most once.
+    int* q = workQueue.data();
+    int qHead = 0;
+    int qTail = 0;
+    // visited[u] == epoch if tile at index u has been visited by algorithm.
+    uint32_t* visited = workVisited.data();
+    uint32_t epoch = workEpoch;
     // endFound is true if ending tile was visited, false otherwise.
     bool endFound = false;
+    // Neighbors looked at, and the longest the queue got, for the query statistics.
+    long long edges = 0;
+    int peak = 1;
 
-    // Create new int array of size numVertices, saying which tile is the parent/predecessor of the tile at given index.
+    // Int array saying which tile is the parent/predecessor of the tile at given index.
     // Example: If p[3] = 5, then vertex 5 comes before vertex 3 in the shortest path.
-    int* p = new int[numVertices] {-1};
+    int* p = workParent.data();
     
     // Indices of source and destination tiles.
     int src = source->index;
     int dest = destin->index;
     
     // Source tile is visited first.
-    visited[src] = true;
+    visited[src] = epoch;
+    nodesExpanded = 0;
 
-    q.push(src);
+    q[qTail++] = src;
 
     // While the queue is nonempty and the ending tile has not been visited yet, visit the next tile in the queue,
     // mark each of its nearest neighbors as visited if they haven't been visited yet and are not obstacles, and 
     // add each one to the queue if they are not obstacles.  If ending tile is found, empty the queue and break out
     // of the for-loop.
-    while (!q.empty() && !endFound)
+    while (qHead < qTail && !endFound)
     {
-        int u = q.front();
-        visited[u] = true;
-        q.pop();
+        int u = q[qHead++];
+        nodesExpanded++;
 
         int i = u / tilesX;
         int j = u % tilesX;
         Tile* current = posToTile[{i, j}].first;
-        set<Tile*> adj = graphMap[current];
+        const set<Tile*>& adj = graphMap[current];
 
         for (Tile* n: adj)
         {
             int v = n->index;
+            edges++;
 			
-            if (!visited[v] && !(n->isObst))
+            if (visited[v] != epoch && !obstacleMask[v])
             {
-                visited[v] = true;
+                visited[v] = epoch;
 				p[v] = u;
 				
-				if (v == destin->index)
+				if (v == dest)
 				{
 					endFound = true;
 					break;
 				}
 				
                 else
-                    q.push(v);
+                    q[qTail++] = v;
             }
         }
+
+        peak = std::max(peak, qTail - qHead);
     }
 
+    queryStats.edgesScanned = edges;
+    queryStats.peakQueue = peak;
+
     // If ending tile wasn't found, set p[ending tiles's index] = -1.
     if (!endFound)
-        p[destin->index] = -1;
+        p[dest] = -1;
 
     // Algorithm over, stop the clock.
     auto stop = high_resolution_clock::now();
     duration = stop - start;
-    
-    // Free up memory taken up by visited.
-    delete[] visited;
-    visited = nullptr;
 
     return p;
 }
 
+void Board::makeExpressLanes()
+{
+    /*
+    Lays skip list style express lanes over the linked list, so that traverseLL can reach a node in at most about
+    tilesY / laneRows + laneRows + tilesX / laneTiles + laneTiles hops instead of one hop per node before it.  Each
+    lane points further along the serpentine order the list is walked in: the widest jumps laneRows rows from the
+    first node of a row, the next jumps one row, and the last jumps laneTiles nodes within a row.
+    */
+
+    // List the nodes in serpentine order: row 0 left to right, row 1 right to left, and so on.
+    vector<Node*> order;
+    order.reserve(nodePool.size());
+
+    for (int i = 0; i < tilesY; i++)
+    {
+        for (int k = 0; k < tilesX; k++)
+            order.push_back(&nodePool[i * tilesX + (i % 2 == 0 ? k : tilesX - 1 - k)]);
+    }
+
+    int count = order.size();
+
+    for (int u = 0; u < count; u++)
+    {
+        if (u % (laneRows * tilesX) == 0 && u + laneRows * tilesX < count)
+            order[u]->skipRows = order[u + laneRows * tilesX];
+
+        if (u % tilesX == 0 && u + tilesX < count)
+            order[u]->skipRow = order[u + tilesX];
+
+        if (u % tilesX % laneTiles == 0 && u % tilesX + laneTiles < tilesX)
+            order[u]->skipTiles = order[u + laneTiles];
+    }
+}
+
 Board::Node* Board::traverseLL(int index)
 {
     /*
     Traverses the LL from head node to node at given index and returns a pointer to that node.
     We are traversing the list as if it was a line.  We start at the head and go right until we reach the end of
     row 0, then down to row 1 and go to the left until we reach the left end of row 1, go down, and go to the right,
-    and so on, until we reach the node.
+    and so on, until we reach the node.  Rather than taking every step, we ride the express lanes set up by
+    makeExpressLanes as far as they go without passing the node: whole blocks of rows, then single rows, then
+    laneTiles nodes at a time along the node's row.  Only the last few steps are taken one node at a time.
     */
     Node* temp = head;
     // Node at index is at position {indexI, indexJ} on the grid.
@@ -540,8 +1151,29 @@ Board::Node* Board::traverseLL(int index)
     if (indexI % 2 == 1)
         index = (indexI * tilesX) + (tilesX - 1 - indexJ);
 
-    // Starting from the head, traverse the list index number of moves to reach the desired node.
-    for (int u = 0; u < index; u++)
+    // Position of temp in the serpentine order.
+    int position = 0;
+
+    while (position + laneRows * tilesX <= index)
+    {
+        temp = temp->skipRows;
+        position += laneRows * tilesX;
+    }
+
+    while (position + tilesX <= index)
+    {
+        temp = temp->skipRow;
+        position += tilesX;
+    }
+
+    while (position + laneTiles <= index)
+    {
+        temp = temp->skipTiles;
+        position += laneTiles;
+    }
+
+    // From there, traverse the list the remaining number of moves to reach the desired node.
+    for (int u = position; u < index; u++)
     {
         int i = u / tilesX;
         int j;
@@ -577,8 +1209,8 @@ int* Board::shortestPathLL()
     Traverse the linked list from head to source and return the source node.
     Then traverse the linked list from head to destin and return the destin node.
     Then find the shortest path between the two nodes.
-    There are many ways to optimize this, but the point is to use a linked list as a linked list
-    whereby to get to a given node, one must traverse the entire list as if it were a line.
+    The point is to use a linked list as a linked list, whereby to get to a given node, one must traverse the list as
+    if it were a line, though the traversal skips ahead along its express lanes.
     */
     int u = source->index;
     int v = destin->index;
@@ -587,6 +1219,8 @@ int* Board::shortestPathLL()
     auto start = high_resolution_clock::now();
     Node* src = traverseLL(u);
     Node* dest = traverseLL(v);
+    // The seek through the list is reported apart from the search.
+    queryStats.seekMs = std::chrono::duration<double, std::milli>(high_resolution_clock::now() - start).count();
 
     // Find shortest path between source (start) and destination (end) tiles.
     int* p = shortestPathNodes(src, dest);
@@ -597,372 +1231,3982 @@ int* Board::shortestPathLL()
     return p;
 }
 
-int* Board::shortestPathNodes(Node* start, Node* end)
+int* Board::shortestPathFlat()
 {
     /*
-    Does the same as shortestPathGraph, but for the LL implementation.  The same comments apply as in that function,
-    but we will comment code that applies specifically to this function.
+    Does the same as shortestPathGraph, but for the flat (CSR) implementation.  The queue, the visited marks, the
+    obstacle flags and the adjacency lists are all contiguous arrays indexed by vertex, so no tile is looked up and
+    no neighbor set is copied while searching.  Like shortestPathGraph, it runs in the search workspace, so it
+    allocates nothing and clears nothing per tile before it starts.
     */
-    int numVertices = graphMap.size();
-    queue<int> q;
-    bool* visited = new bool[numVertices] {false};
+    auto start = high_resolution_clock::now();
+
+    beginSearch();
+    // Every vertex is pushed at most once, so a plain array with a head and tail index is enough for the queue.
+    int* q = workQueue.data();
+    int qHead = 0;
+    int qTail = 0;
+    uint32_t* visited = workVisited.data();
+    uint32_t epoch = workEpoch;
     bool endFound = false;
-    int* p = new int[numVertices] {-1};
-    int strt = start->tPtr->index;
-    int dest = end->tPtr->index;
-    visited[strt] = true;
+    long long edges = 0;
+    int peak = 1;
+    int* p = workParent.data();
+    int src = source->index;
+    int dest = destin->index;
+    const int* offsets = csrOffsets.data();
+    const int* targets = csrTargets.data();
+    const char* obst = obstacleMask.data();
+    visited[src] = epoch;
+    nodesExpanded = 0;
 
-    q.push(strt);
+    q[qTail++] = src;
 
-    while (!q.empty() && !endFound)
+    while (qHead < qTail && !endFound)
     {
-        int u = q.front();
-        visited[u] = true;
-        
-        q.pop();
+        int u = q[qHead++];
+        nodesExpanded++;
 
-        int i = u / tilesX;
-        int j = u % tilesX;
-        Node* current = posToTile[{i, j}].second;
-        // Set of nodes consisting of nearest neighbor nodes of current node in the queue.
-        set<Node*> adj;
-
-        // Insert each nearest neighbor into adj.
-        adj.insert(current->botLeft);
-        adj.insert(current->down);
-        adj.insert(current->botRight);
-        adj.insert(current->left);
-        adj.insert(current->right);
-        adj.insert(current->topLeft);
-        adj.insert(current->up);
-        adj.insert(current->topRight);
-
-        for (Node* n: adj)
+        for (int e = offsets[u]; e < offsets[u + 1]; e++)
         {
-            // If one of the nearest neighbors is nonexistent, move onto the next nearest neighbor node.
-            // For example, if current node is at row 0, there will be no nearest neighbors above the node.
-            if (n == nullptr)
-                continue;
+            int v = targets[e];
+            edges++;
 
-            int v = n->tPtr->index;
-			
-            if (!visited[v] && !(n->tPtr->isObst))
+            if (visited[v] != epoch && !obst[v])
             {
-                visited[v] = true;
-				p[v] = u;
-				
-				if (v == dest)
-				{
-					endFound = true;
-					break;
-				}
-				
+                visited[v] = epoch;
+                p[v] = u;
+
+                if (v == dest)
+                {
+                    endFound = true;
+                    break;
+                }
+
                 else
-                    q.push(v);
+                    q[qTail++] = v;
             }
         }
+
+        peak = std::max(peak, qTail - qHead);
     }
 
+    queryStats.edgesScanned = edges;
+    queryStats.peakQueue = peak;
+
     if (!endFound)
         p[dest] = -1;
 
-    delete[] visited;
-    visited = nullptr;
+    auto stop = high_resolution_clock::now();
+    duration = stop - start;
 
     return p;
 }
 
-void Board::displayShortestPath(int* p)
+void Board::makePaddedGrid()
 {
     /*
-    This function will take the p array and push the tiles making up the shortest path to vector shortestPath.
-    Each tile (except source and destination tiles) will have its color changed to yellow.  If no path exists,
-    push nullptr to shortestPath and exit the function.
+    Builds paddedBlocked: the obstacle flags of the board with a ring of blocked sentinel tiles around it, so a
+    neighbor offset from any board tile lands on a real entry and the ring stops the search at the border without
+    any bounds checks.
     */
-    if (p[destin->index] == -1)
-        shortestPath.push_back(nullptr);
+    gridWidth = tilesX;
+    gridHeight = tilesY;
+    paddedBlocked.assign((gridWidth + 2) * (gridHeight + 2), 1);
 
-    else
+    for (int i = 0; i < gridHeight; i++)
     {
-        shortestPath.push_back(source);
-        int prev = p[destin->index];
-	
-	    while (prev != source->index)
-	    {
-		    int i = prev / tilesX;
-            int j = prev % tilesX;
-            posToTile[{i, j}].first->setTileColor(sf::Color::Yellow);
-            shortestPath.push_back(posToTile[{i, j}].first);
-		    prev = p[prev];
-	    }
+        for (int j = 0; j < gridWidth; j++)
+            paddedBlocked[(i + 1) * (gridWidth + 2) + j + 1] = obstacleMask[i * gridWidth + j];
     }
-
-    delete[] p;
-    p = nullptr;
 }
 
-void Board::resetBoard()
+template <int W, int H, int Conn>
+int* Board::shortestPathGrid(int width, int height)
 {
     /*
-    This function runs when user selects to reset board button.  Board is reset so that all tiles are black and
-    all selections are undone.  It allows the user to start over.
+    BFS on paddedBlocked, with the grid's width, height and connectivity (4 or 8 neighbors) as template parameters.
+    With W and H known at compile time the row stride is a constant, the neighbor offsets are immediates, and
+    the queue, the parents and the visited test all work on padded indices, so nothing is divided until the path
+    is converted back to tile indices at the end.  The sentinel ring takes the place of border checks.  W = H = 0
+    is the run-time fallback: the same code, with the width and height passed in.  The queue, parents and visited
+    stamps are kept by the board, and the path is written into the search workspace's workParent, so a search
+    allocates nothing and clears nothing.
     */
+    auto start = high_resolution_clock::now();
 
-    // Reset source tile selection.
-    if (source != nullptr)
+    const int w = W > 0 ? W : width;
+    const int h = H > 0 ? H : height;
+    const int stride = w + 2;
+    const int numPadded = stride * (h + 2);
+    const char* blocked = paddedBlocked.data();
+
+    if (gridSeen.size() != numPadded)
     {
-        source->setTileColor(sf::Color::Black);
-        source->isSource = false;
-        source = nullptr;
+        gridQueue.assign(w * h, 0);
+        gridFrom.assign(numPadded, -1);
+        gridSeen.assign(numPadded, 0);
+        gridEpoch = 0;
     }
 
-    // Reset destination tile selection.
-    if (destin != nullptr)
+    // Advancing the stamp unmarks every padded index at once.
+    if (++gridEpoch == 0)
     {
-        destin->setTileColor(sf::Color::Black);
-        destin->isDest = false;
-        destin = nullptr;
+        std::fill(gridSeen.begin(), gridSeen.end(), 0);
+        gridEpoch = 1;
     }
 
-    // Reset member variables to their default values.
-    mapSelected = false;
-    linkedListSelected = false;
-    goButtonClicked = false;
-    tryAgainClicked = false;
-    source = nullptr;
-    destin = nullptr;
+    int* q = gridQueue.data();
+    int qHead = 0;
+    int qTail = 0;
+    // Parent of each padded index, only meaningful where seen is the current stamp.
+    int* from = gridFrom.data();
+    uint32_t* seen = gridSeen.data();
+    uint32_t epoch = gridEpoch;
+    int src = (source->index / w + 1) * stride + source->index % w + 1;
+    int dest = (destin->index / w + 1) * stride + destin->index % w + 1;
+    from[src] = src;
+    seen[src] = epoch;
+    q[qTail++] = src;
+    int peak = 1;
 
-    // If any obstacles were selected, undo the selections by setting the relevant variables to false,
-    // and reset the color of the obstacle tiles to black.
-    for (auto obstacle: obstacles)
+    // The stencil is written out, so each neighbor is a constant offset from u and there is no loop over them.
+    // The destination is only checked once per tile, after all of its neighbors.
+    while (qHead < qTail && seen[dest] != epoch)
     {
-        obstacle->setTileColor(sf::Color::Black);
-        obstacle->isObst = false;
+        int u = q[qHead++];
+        auto visit = [&](int v)
+        {
+            if (!blocked[v] && seen[v] != epoch)
+            {
+                seen[v] = epoch;
+                from[v] = u;
+                q[qTail++] = v;
+            }
+        };
+
+        visit(u - stride);
+        visit(u - 1);
+        visit(u + 1);
+        visit(u + stride);
+
+        if (Conn == 8)
+        {
+            visit(u - stride - 1);
+            visit(u - stride + 1);
+            visit(u + stride - 1);
+            visit(u + stride + 1);
+        }
+
+        peak = std::max(peak, qTail - qHead);
     }
 
-    // Clear the obstacles set.
-    obstacles.clear();
+    bool endFound = seen[dest] == epoch;
+    nodesExpanded = qHead;
+    // Every tile taken off the queue looks at all of its Conn neighbors.
+    queryStats.edgesScanned = (long long)qHead * Conn;
+    queryStats.peakQueue = peak;
 
-    // If the shortest path algorithm was previously run, shortestPath vector will be populated
-    // If vector has tiles making up a previously found shortest path, reset their color to black
-    if (shortestPath.size() > 0 && shortestPath[0] != nullptr)
+    beginSearch();
+    int* p = workParent.data();
+
+    if (!endFound)
+        p[destin->index] = -1;
+
+    else
     {
-        for (int i = 0; i < shortestPath.size(); i++)
-            shortestPath[i]->setTileColor(sf::Color::Black);
+        // Convert the path back to tile indices.  Only the path's entries are written.
+        for (int v = dest; v != src; v = from[v])
+            p[(v / stride - 1) * w + v % stride - 1] = (from[v] / stride - 1) * w + from[v] % stride - 1;
     }
 
-    // Clear the shortestPath vector.
-    shortestPath.clear();
+    auto stop = high_resolution_clock::now();
+    duration = stop - start;
+
+    return p;
 }
 
-/*==== Public Functions ====*/
+int* Board::shortestPathSpecialized()
+{
+    /*
+    Finds the shortest path with shortestPathGrid specialized for this board's dimensions and gridConnectivity.
+    */
+    if (gridConnectivity == 4)
+        return shortestPathGrid<tilesX, tilesY, 4>(tilesX, tilesY);
 
-Board::Board()
+    return shortestPathGrid<tilesX, tilesY, 8>(tilesX, tilesY);
+}
+
+int* Board::shortestPathRuntimeGrid()
 {
     /*
-    Board constructor.  Sets member variables to default values.
+    Finds the shortest path with the run-time sized fallback of shortestPathGrid, for comparison.  The dimensions
+    come from gridWidth and gridHeight, which the compiler can't assume are constant.
     */
-    head = nullptr;
-    source = nullptr;
-    destin = nullptr;
-    mapSelected = false;
-    linkedListSelected = false;
-    goButtonClicked = false;
-    tryAgainClicked = false;
-    makeGraphs();
+    if (gridConnectivity == 4)
+        return shortestPathGrid<0, 0, 4>(gridWidth, gridHeight);
+
+    return shortestPathGrid<0, 0, 8>(gridWidth, gridHeight);
 }
 
-Board::~Board()
+// Helpers for shortestPathBits.  Each bitboard row holds bitWordsPerRow words between two zero padding words, so
+// the word before or after any word of a row can always be read.  Shifting a row left by one column is
+// (x << 1) | (previous word >> 63), and shifting it right is (x >> 1) | (next word << 63).
+
+static void dilateRowsScalar(const uint64_t* frontier, uint64_t* dilated, int firstRow, int lastRow)
+{
+    /*
+    For rows firstRow to lastRow, sets dilated to the frontier OR'd with itself shifted one column left and right.
+    */
+    for (int r = firstRow; r <= lastRow; r++)
+    {
+        const uint64_t* f = frontier + r * bitStride + 1;
+        uint64_t* d = dilated + r * bitStride + 1;
+
+        for (int k = 0; k < bitWordsPerRow; k++)
+            d[k] = f[k] | (f[k] << 1) | (f[k - 1] >> 63) | (f[k] >> 1) | (f[k + 1] << 63);
+    }
+}
+
+static bool combineRowsScalar(const uint64_t* dilated, const uint64_t* freeBits, uint64_t* visited, uint64_t* next, int firstRow, int lastRow)
 {
     /*
-    Destructor that will free up any remaining memory, clearing out the data structures.
+    For rows firstRow to lastRow, sets next to the free, unvisited tiles in the dilated rows above, at and below,
+    and marks them visited.  Returns true if any tile was added.
     */
-    map<pair<int, int>, pair<Tile*, Node*>>::iterator iter;
-    vector<Node*> nodesToDelete;
-    vector<Tile*> tilesToDelete;
+    uint64_t any = 0;
 
-    // Iterate through m and add each node and tile pointer to the associated vector.
-    for (iter = posToTile.begin(); iter != posToTile.end(); ++iter)
+    for (int r = firstRow; r <= lastRow; r++)
     {
-        nodesToDelete.push_back(iter->second.second);
-        tilesToDelete.push_back(iter->second.first);
+        int row = r * bitStride + 1;
+
+        for (int k = row; k < row + bitWordsPerRow; k++)
+        {
+            uint64_t n = (dilated[k - bitStride] | dilated[k] | dilated[k + bitStride]) & freeBits[k] & ~visited[k];
+            next[k] = n;
+            visited[k] |= n;
+            any |= n;
+        }
     }
 
-    // Delete each Node and Tile, and set each pointer to nullptr.
-    for (int i = 0; i < nodesToDelete.size(); i++)
+    return any != 0;
+}
+
+#ifdef BITBOARD_AVX2
+__attribute__((target("avx2")))
+static void dilateRowsAVX2(const uint64_t* frontier, uint64_t* dilated, int firstRow, int lastRow)
+{
+    /*
+    Same as dilateRowsScalar, four words at a time.  The unaligned loads one word before and after supply the
+    bits that carry across word boundaries.
+    */
+    for (int r = firstRow; r <= lastRow; r++)
     {
-        delete nodesToDelete[i];
-        delete tilesToDelete[i];
-        nodesToDelete[i] = nullptr;
-        tilesToDelete[i] = nullptr;
+        const uint64_t* f = frontier + r * bitStride + 1;
+        uint64_t* d = dilated + r * bitStride + 1;
+
+        for (int k = 0; k < bitWordsPerRow; k += 4)
+        {
+            __m256i x = _mm256_loadu_si256((const __m256i*)(f + k));
+            __m256i before = _mm256_loadu_si256((const __m256i*)(f + k - 1));
+            __m256i after = _mm256_loadu_si256((const __m256i*)(f + k + 1));
+            __m256i left = _mm256_or_si256(_mm256_slli_epi64(x, 1), _mm256_srli_epi64(before, 63));
+            __m256i right = _mm256_or_si256(_mm256_srli_epi64(x, 1), _mm256_slli_epi64(after, 63));
+            _mm256_storeu_si256((__m256i*)(d + k), _mm256_or_si256(x, _mm256_or_si256(left, right)));
+        }
     }
+}
 
-    // Clear member vectors/maps and graph data structures.  Set pointers to nullptr.
-    posToTile.clear();
-    graphMap.clear();
-    shortestPath.clear();
-    obstacles.clear();
-    head = nullptr;
-    source = nullptr;
-    destin = nullptr;
+__attribute__((target("avx2")))
+static bool combineRowsAVX2(const uint64_t* dilated, const uint64_t* freeBits, uint64_t* visited, uint64_t* next, int firstRow, int lastRow)
+{
+    /*
+    Same as combineRowsScalar, four words at a time.
+    */
+    __m256i any = _mm256_setzero_si256();
+
+    for (int r = firstRow; r <= lastRow; r++)
+    {
+        int row = r * bitStride + 1;
+
+        for (int k = row; k < row + bitWordsPerRow; k += 4)
+        {
+            __m256i above = _mm256_loadu_si256((const __m256i*)(dilated + k - bitStride));
+            __m256i at = _mm256_loadu_si256((const __m256i*)(dilated + k));
+            __m256i below = _mm256_loadu_si256((const __m256i*)(dilated + k + bitStride));
+            __m256i freeWords = _mm256_loadu_si256((const __m256i*)(freeBits + k));
+            __m256i seen = _mm256_loadu_si256((const __m256i*)(visited + k));
+            __m256i n = _mm256_andnot_si256(seen, _mm256_and_si256(_mm256_or_si256(above, _mm256_or_si256(at, below)), freeWords));
+            _mm256_storeu_si256((__m256i*)(next + k), n);
+            _mm256_storeu_si256((__m256i*)(visited + k), _mm256_or_si256(seen, n));
+            any = _mm256_or_si256(any, n);
+        }
+    }
+
+    return !_mm256_testz_si256(any, any);
 }
+#endif
 
-void Board::play(sf::RenderWindow& window)
+int* Board::shortestPathBits()
 {
     /*
-    This function is the function that runs in main() and is responsible for displaying the window, board, text,
-    and is responsible for accepting user input and outputting results.
+    Finds the shortest path for the bitboard implementation.  The visited set and each BFS level (frontier) are
+    bitboards, so a whole level is expanded at once: the frontier is spread one column left and right, then one row
+    up and down, and AND'ed with the free tiles that have not been visited.  The rows spanned by every level are
+    kept in bitLevels, and the path is rebuilt backwards from the destination by stepping to any neighbor in the
+    level before.  Uses AVX2 when the processor supports it.
     */
-    while (window.isOpen())
+    auto start = high_resolution_clock::now();
+
+    int numVertices = indexToTile.size();
+    int* p = new int[numVertices] {-1};
+    int src = source->index;
+    int dest = destin->index;
+    int destWord = (dest / tilesX + 1) * bitStride + 1 + (dest % tilesX) / 64;
+    uint64_t destBit = uint64_t(1) << (dest % tilesX % 64);
+
+    // The current frontier and the level being built alternate between these two boards.
+    vector<uint64_t> frontierBoard(bitBoardWords, 0);
+    vector<uint64_t> nextBoard(bitBoardWords, 0);
+    vector<uint64_t> visited(bitBoardWords, 0);
+    vector<uint64_t> dilated(bitBoardWords, 0);
+    uint64_t* frontier = frontierBoard.data();
+    uint64_t* next = nextBoard.data();
+    frontier[(src / tilesX + 1) * bitStride + 1 + (src % tilesX) / 64] |= uint64_t(1) << (src % tilesX % 64);
+    visited = frontierBoard;
+
+    bool useAVX2 = false;
+#ifdef BITBOARD_AVX2
+    useAVX2 = __builtin_cpu_supports("avx2");
+#endif
+
+    // Rows (1 to tilesY) spanned by the current frontier, and rows of next written by the level before last.
+    int firstRow = src / tilesX + 1;
+    int lastRow = firstRow;
+    int staleFirst = 1;
+    int staleLast = 0;
+    int level = 0;
+    bool endFound = false;
+    nodesExpanded = 0;
+
+    // Level 0 is just the source row.
+    bitLevels.clear();
+    bitLevelRows.clear();
+    bitLevelRows.push_back({firstRow, lastRow});
+    bitLevels.insert(bitLevels.end(), frontier + firstRow * bitStride + 1, frontier + firstRow * bitStride + 1 + bitWordsPerRow);
+
+    while (!endFound)
     {
-        // Clear contents of previous frame.
-        window.clear();
+        for (int k = firstRow * bitStride; k < (lastRow + 1) * bitStride; k++)
+            nodesExpanded += __builtin_popcountll(frontier[k]);
 
-        // Event object: events include mouse being pressed, keyboard press, etc.
-        sf::Event event;
-        while (window.pollEvent(event))
+        // The next level can only reach one row beyond the frontier in each direction.  The dilation is computed
+        // one row further still, where the frontier is zero, so the rows read by the combine step are up to date.
+        int nextFirst = std::max(firstRow - 1, 1);
+        int nextLast = std::min(lastRow + 1, tilesY);
+        bool any;
+
+        // Clear what is left in next from two levels ago.
+        for (int r = staleFirst; r <= staleLast; r++)
+            std::fill(next + r * bitStride + 1, next + r * bitStride + 1 + bitWordsPerRow, 0);
+
+#ifdef BITBOARD_AVX2
+        if (useAVX2)
         {
-            // Event recorded is one that is reponsible for closing the window.
-            if (event.type == sf::Event::Closed)
-                window.close();
+            dilateRowsAVX2(frontier, dilated.data(), nextFirst - 1, nextLast + 1);
+            any = combineRowsAVX2(dilated.data(), freeBits.data(), visited.data(), next, nextFirst, nextLast);
+        }
 
-            // User pressed a mouse button.
-            else if (event.type == sf::Event::MouseButtonPressed)
-            {
-                // Record the position of the mouse when user pressed a mouse button.
-                sf::Vector2i position = sf::Mouse::getPosition(window);
-                // Find what tile the user clicked on (if any).
-                int i = position.y / (ySize + 1);
-                int j = position.x / (xSize + 1);
+        else
+#endif
+        {
+            dilateRowsScalar(frontier, dilated.data(), nextFirst - 1, nextLast + 1);
+            any = combineRowsScalar(dilated.data(), freeBits.data(), visited.data(), next, nextFirst, nextLast);
+        }
 
-                // User left-clicked on a tile.
-                if (event.mouseButton.button == sf::Mouse::Left && i < tilesY && j < tilesX)
-                {
-                    // Source tile has not been selected yet, so tile selected will be source tile,
-                    // as long as it wasn't selected to be an obstacle.
-                    if (source == nullptr && !posToTile[{i, j}].first->isObst)
-                    {
-                        posToTile[{i, j}].first->setTileColor(sf::Color::Green);
-                        source = posToTile[{i, j}].first;
-                        posToTile[{i, j}].first->isSource = true;
-                    }
+        // Frontier is empty: the destination cannot be reached.
+        if (!any)
+            break;
 
-                    // Source tile was already selected and user clicked on that same tile: undo selection.
-                    else if (source == posToTile[{i, j}].first && destin == nullptr)
-                    {
-                        posToTile[{i, j}].first->setTileColor(sf::Color::Black);
-                        source = nullptr;
-                        posToTile[{i, j}].first->isSource = false;
-                    }
+        level++;
+        endFound = (next[destWord] & destBit) != 0;
 
-                    // Source tile was already selected and user clicked on a different tile, setting it as the destination,
-                    // as long as it wasn't selected to be an obstacle.
-                    else if (source != posToTile[{i, j}].first && destin == nullptr && !posToTile[{i, j}].first->isObst)
-                    {
-                        posToTile[{i, j}].first->setTileColor(sf::Color::Red);
-                        destin = posToTile[{i, j}].first;
-                        posToTile[{i, j}].first->isDest = true;
-                    }
+        // Shrink the row span to the rows that actually hold part of the new frontier.
+        firstRow = nextLast;
+        lastRow = nextFirst;
 
-                    // Destination tile was already selected and user clicked on that same tile: undo selection.
-                    else if (destin == posToTile[{i, j}].first)
-                    {
-                        posToTile[{i, j}].first->setTileColor(sf::Color::Black);
-                        destin = nullptr;
-                        posToTile[{i, j}].first->isDest = false;
-                    }
+        for (int r = nextFirst; r <= nextLast; r++)
+        {
+            for (int k = r * bitStride + 1; k < r * bitStride + 1 + bitWordsPerRow; k++)
+            {
+                if (next[k])
+                {
+                    firstRow = std::min(firstRow, r);
+                    lastRow = std::max(lastRow, r);
+                    break;
                 }
+            }
+        }
 
-                // User right-clicked on a tile and the Go button wasn't pressed.
-                else if (event.mouseButton.button == sf::Mouse::Right && i < tilesX && j < tilesY && !goButtonClicked)
-                {
-                    // User right-clicked on an empty tile (not source and not destination)
-                    // Set that tile as an obstacle tile, as long as there is room for a source and destination tile.
-                    if (source != posToTile[{i, j}].first && destin != posToTile[{i, j}].first && posToTile[{i, j}].first->isObst == false && obstacles.size() < graphMap.size() - 2)
-                    {
-                        posToTile[{i, j}].first->setTileColor(sf::Color::Magenta);
-                        posToTile[{i, j}].first->isObst = true;
-                        obstacles.insert(posToTile[{i, j}].first);
-                    }
+        // Keep the rows of the new level for rebuilding the path.
+        bitLevelRows.push_back({firstRow, lastRow});
 
-                    // Undo selection of an obstacle tile.
-                    else if (posToTile[{i, j}].first->isObst)
-                    {
-                        posToTile[{i, j}].first->setTileColor(sf::Color::Black);
-                        posToTile[{i, j}].first->isObst = false;
-                        obstacles.erase(posToTile[{i, j}].first);
-                    }
-                }
+        for (int r = firstRow; r <= lastRow; r++)
+            bitLevels.insert(bitLevels.end(), next + r * bitStride + 1, next + r * bitStride + 1 + bitWordsPerRow);
 
-                // User left-clicked off the grid, where user-selections take place.
-                else if (event.mouseButton.button == sf::Mouse::Left && j > tilesY)
-                {
-                    // User clicked on the LL button before Go button was pressed, thereby choosing the LL implementation.
-                    if(linkedListSprite.getGlobalBounds().contains(position.x, position.y) && !linkedListSelected && !goButtonClicked)
-                    {
-                        linkedListSelected = true;
-                        mapSelected = false;
-                    }
+        staleFirst = nextFirst;
+        staleLast = nextLast;
+        std::swap(frontier, next);
+    }
 
-                    // User clicked on the map button before Go button was pressed, thereby choosing the map implementation.
-                    else if (mapSprite.getGlobalBounds().contains(position.x, position.y) && !mapSelected && !goButtonClicked)
-                    {
-                        mapSelected = true;
-                        linkedListSelected = false;
-                    }
+    if (!endFound)
+        p[dest] = -1;
 
-                    // User clicked on reset board button.
-                    else if (resetSprite.getGlobalBounds().contains(position.x, position.y))
-                        resetBoard();
+    else
+    {
+        // Offset of each level's first row in bitLevels.
+        vector<int> offsets(level + 1, 0);
 
-                    // User clicked on Go button, so run the appropriate shortest path algorithm, depending on which graph implemented they selected.
-                    else if (goSprite.getGlobalBounds().contains(position.x, position.y) && shortestPath.size() == 0)
-                    {
-                        goButtonClicked = true;
-                        tryAgainClicked = true;
-                        int* p;
+        for (int l = 1; l <= level; l++)
+            offsets[l] = offsets[l - 1] + (bitLevelRows[l - 1].second - bitLevelRows[l - 1].first + 1) * bitWordsPerRow;
 
-                        // User selected the map implementation.
-                        if (mapSelected)
-                            p = shortestPathGraph();
+        // Walk back from the destination: at each level, step to a neighbor that was in the level before.
+        int u = dest;
 
-                        // User selected the LL implementation.
-                        else if (linkedListSelected)
-                            p = shortestPathLL();
+        for (int l = level - 1; l >= 0; l--)
+        {
+            int i = u / tilesX;
+            int j = u % tilesX;
+            bool stepped = false;
 
-                        // After algorithm finishes, display the shortest path if it exists.
-                        displayShortestPath(p);
-                    }
+            for (int di = -1; di <= 1 && !stepped; di++)
+            {
+                for (int dj = -1; dj <= 1 && !stepped; dj++)
+                {
+                    int ni = i + di;
+                    int nj = j + dj;
 
-                    // User clicked Try Again button, so user can run the algorithm again using the same tile selections.
-                    // This allows the user to quickly compare graph implementations in terms of running time.
-                    else if (tryAgainSprite.getGlobalBounds().contains(position.x, position.y))
+                    // Board rows are stored one lower in the bitboard because of the padding row.
+                    if ((di == 0 && dj == 0) || nj < 0 || nj >= tilesX || ni + 1 < bitLevelRows[l].first || ni + 1 > bitLevelRows[l].second)
+                        continue;
+
+                    if (bitLevels[offsets[l] + (ni + 1 - bitLevelRows[l].first) * bitWordsPerRow + nj / 64] & (uint64_t(1) << (nj % 64)))
                     {
-                        tryAgainClicked = false;
-                        goButtonClicked = false;
-                        mapSelected = false;
-                        linkedListSelected = false;
-                        
-                        // There was a path that was found during the most recent run, so make the path tiles (except
-                        // for the source and destination tiles) return to their default color (Black).
-                        if (shortestPath[0] != nullptr)
-                        {
-                            for (int i = 0; i < shortestPath.size(); i++)
-                            {
-                                if (!shortestPath[i]->isSource && !shortestPath[i]->isDest)
-                                    shortestPath[i]->setTileColor(sf::Color::Black);
-                            }
-                        }
-                        
-                        // Clear the vector whether or not a path was found.
-                        shortestPath.clear();
+                        p[u] = ni * tilesX + nj;
+                        u = p[u];
+                        stepped = true;
                     }
                 }
             }
         }
-
-        // After all updates have finished processing, display the updated state of the board.
-        displayBoard(window);
-        window.display();
     }
+
+    auto stop = high_resolution_clock::now();
+    duration = stop - start;
+
+    return p;
+}
+
+int* Board::shortestPathDirOpt()
+{
+    /*
+    Direction-optimizing BFS on the CSR arrays.  Each level is expanded either top-down, where every frontier tile
+    looks at its neighbors for unvisited tiles (as in shortestPathFlat), or bottom-up, where every unvisited tile
+    looks at its neighbors for a parent in the frontier and stops at the first one found.  Bottom-up is cheaper once
+    the frontier is large, since most of the top-down checks would land on visited tiles.
+    The search goes bottom-up when the edges leaving the frontier exceed 1/dirAlpha of the edges of unvisited tiles,
+    and back to top-down when the frontier holds fewer than 1/dirBeta of the tiles.
+    */
+    auto start = high_resolution_clock::now();
+
+    int numVertices = indexToTile.size();
+    bool* visited = new bool[numVertices] {false};
+    bool* inFrontier = new bool[numVertices] {false};
+    int* p = new int[numVertices] {-1};
+    int src = source->index;
+    int dest = destin->index;
+    const int* offsets = csrOffsets.data();
+    const int* targets = csrTargets.data();
+    const char* obst = obstacleMask.data();
+    vector<int> frontier(1, src);
+    vector<int> next;
+    bool endFound = false;
+    bool bottomUp = false;
+    int level = 0;
+    visited[src] = true;
+    nodesExpanded = 0;
+    levelStats.clear();
+
+    // Edges of the free tiles that have not been visited yet.
+    long long unexploredEdges = 0;
+
+    for (int u = 0; u < numVertices; u++)
+    {
+        if (!obst[u] && u != src)
+            unexploredEdges += offsets[u + 1] - offsets[u];
+    }
+
+    while (!frontier.empty() && !endFound)
+    {
+        long long frontierEdges = 0;
+
+        for (int u: frontier)
+            frontierEdges += offsets[u + 1] - offsets[u];
+
+        if (!bottomUp && frontierEdges > unexploredEdges / dirAlpha)
+            bottomUp = true;
+
+        else if (bottomUp && frontier.size() < numVertices / dirBeta)
+            bottomUp = false;
+
+        LevelStats stats = {level, bottomUp, (int)frontier.size(), 0};
+        next.clear();
+
+        if (!bottomUp)
+        {
+            for (int u: frontier)
+            {
+                for (int e = offsets[u]; e < offsets[u + 1] && !endFound; e++)
+                {
+                    int v = targets[e];
+                    stats.edgesChecked++;
+
+                    if (!visited[v] && !obst[v])
+                    {
+                        visited[v] = true;
+                        p[v] = u;
+                        next.push_back(v);
+                        endFound = v == dest;
+                    }
+                }
+
+                if (endFound)
+                    break;
+            }
+        }
+
+        else
+        {
+            for (int u: frontier)
+                inFrontier[u] = true;
+
+            for (int v = 0; v < numVertices && !endFound; v++)
+            {
+                if (visited[v] || obst[v])
+                    continue;
+
+                for (int e = offsets[v]; e < offsets[v + 1]; e++)
+                {
+                    stats.edgesChecked++;
+
+                    if (inFrontier[targets[e]])
+                    {
+                        visited[v] = true;
+                        p[v] = targets[e];
+                        next.push_back(v);
+                        endFound = v == dest;
+                        break;
+                    }
+                }
+            }
+
+            for (int u: frontier)
+                inFrontier[u] = false;
+        }
+
+        for (int v: next)
+            unexploredEdges -= offsets[v + 1] - offsets[v];
+
+        nodesExpanded += frontier.size();
+        levelStats.push_back(stats);
+        frontier.swap(next);
+        level++;
+    }
+
+    if (!endFound)
+        p[dest] = -1;
+
+    auto stop = high_resolution_clock::now();
+    duration = stop - start;
+
+    delete[] visited;
+    visited = nullptr;
+    delete[] inFrontier;
+    inFrontier = nullptr;
+
+    return p;
+}
+
+void Board::multiSourceBatch(const pair<int, int>* queries, int count, BatchResult* results)
+{
+    /*
+    Multi-source BFS (MS-BFS): up to batchWidth queries against the current obstacles are searched together.
+    Bit q of a tile's words stands for query q, so expanding a tile once moves every query whose frontier holds it:
+    the bits of visit[u] that a neighbor has not seen yet are passed on to it in one AND-NOT.  Each level therefore
+    sweeps the tiles once for the whole batch instead of once per query.  A query stops spreading once its
+    destination is reached.  The parent of each tile for each query is kept as a direction (0 to 8, as
+    (row step + 1) * 3 + column step + 1) so that every path can be rebuilt.
+    */
+    int numVertices = indexToTile.size();
+    const int* offsets = csrOffsets.data();
+    const int* targets = csrTargets.data();
+    const char* obst = obstacleMask.data();
+    batchSeen.assign(numVertices, 0);
+    batchVisit.assign(numVertices, 0);
+    batchVisitNext.assign(numVertices, 0);
+    batchParent.resize((size_t)numVertices * batchWidth);
+
+    // Destination tile of each query, and the queries that have not reached theirs yet.
+    vector<int> targetOf(count);
+    uint64_t pending = 0;
+    vector<int> frontier;
+    vector<int> next;
+
+    for (int q = 0; q < count; q++)
+    {
+        int src = queries[q].first;
+        int dest = queries[q].second;
+        uint64_t bit = uint64_t(1) << q;
+        targetOf[q] = dest;
+        results[q].distance = -1;
+        results[q].path.clear();
+
+        if (src < 0 || src >= numVertices || dest < 0 || dest >= numVertices || obst[src] || obst[dest])
+            continue;
+
+        if (src == dest)
+        {
+            results[q].distance = 0;
+            results[q].path.push_back(src);
+            continue;
+        }
+
+        if (batchVisit[src] == 0)
+            frontier.push_back(src);
+
+        batchSeen[src] |= bit;
+        batchVisit[src] |= bit;
+        pending |= bit;
+    }
+
+    int level = 0;
+
+    while (!frontier.empty() && pending != 0)
+    {
+        level++;
+        next.clear();
+
+        for (int u: frontier)
+        {
+            // Only the queries still looking for their destination keep spreading.
+            uint64_t visit = batchVisit[u] & pending;
+            batchVisit[u] = 0;
+            nodesExpanded++;
+
+            if (visit == 0)
+                continue;
+
+            int ui = u / tilesX;
+            int uj = u % tilesX;
+
+            for (int e = offsets[u]; e < offsets[u + 1]; e++)
+            {
+                int v = targets[e];
+
+                if (obst[v])
+                    continue;
+
+                uint64_t reached = visit & ~batchSeen[v];
+
+                if (reached == 0)
+                    continue;
+
+                if (batchVisitNext[v] == 0)
+                    next.push_back(v);
+
+                batchVisitNext[v] |= reached;
+                batchSeen[v] |= reached;
+                char direction = (ui - v / tilesX + 1) * 3 + (uj - v % tilesX + 1);
+
+                for (uint64_t bits = reached; bits != 0; bits &= bits - 1)
+                {
+                    int q = __builtin_ctzll(bits);
+                    batchParent[(size_t)v * batchWidth + q] = direction;
+
+                    if (v == targetOf[q])
+                    {
+                        results[q].distance = level;
+                        pending &= ~(uint64_t(1) << q);
+                    }
+                }
+            }
+        }
+
+        for (int v: next)
+        {
+            batchVisit[v] = batchVisitNext[v];
+            batchVisitNext[v] = 0;
+        }
+
+        frontier.swap(next);
+    }
+
+    // Rebuild each path backwards from the destination by following the stored directions.
+    for (int q = 0; q < count; q++)
+    {
+        if (results[q].distance <= 0)
+            continue;
+
+        int u = targetOf[q];
+        vector<int>& path = results[q].path;
+        path.push_back(u);
+
+        for (int step = 0; step < results[q].distance; step++)
+        {
+            char direction = batchParent[(size_t)u * batchWidth + q];
+            u += (direction / 3 - 1) * tilesX + (direction % 3 - 1);
+            path.push_back(u);
+        }
+
+        std::reverse(path.begin(), path.end());
+    }
+}
+
+pair<int, int> Board::incKey(int u)
+{
+    /*
+    Priority of tile u in the incremental engine's open list.  The heuristic is the Chebyshev (king move) distance
+    to the destination, which is exact on an open 8-connected board and never overestimates.
+    */
+    int best = std::min(incG[u], incRhs[u]);
+    int h = std::max(std::abs(u / tilesX - incDest / tilesX), std::abs(u % tilesX - incDest % tilesX));
+    return {best + h, best};
+}
+
+void Board::incUpdateTile(int u)
+{
+    /*
+    Recomputes rhs of tile u from its neighbors' g values (the source keeps rhs = 0, obstacles get infinity), then
+    queues u if it is inconsistent.  Entries already in the heap for u are not removed; they are skipped when popped
+    if their key no longer matches.
+    */
+    if (u != incSource)
+    {
+        int best = incInfinity;
+
+        if (!obstacleMask[u])
+        {
+            for (int e = csrOffsets[u]; e < csrOffsets[u + 1]; e++)
+            {
+                int v = csrTargets[e];
+
+                if (!obstacleMask[v])
+                    best = std::min(best, incG[v] + 1);
+            }
+        }
+
+        incRhs[u] = std::min(best, incInfinity);
+    }
+
+    if (incG[u] != incRhs[u])
+    {
+        incOpen.push_back({incKey(u), u});
+        std::push_heap(incOpen.begin(), incOpen.end(), std::greater<pair<pair<int, int>, int>>());
+    }
+}
+
+int* Board::shortestPathIncremental()
+{
+    /*
+    Lifelong Planning A* (LPA*) on the CSR arrays.  The g and rhs values and the open list are kept between runs.
+    If the source and destination are the same as last time, only the tiles whose obstacle state changed (and their
+    neighbors) are re-examined, and the search only touches the part of the board whose distances changed.
+    Otherwise the search starts over.  Every move costs 1, so g is the BFS distance from the source.
+    */
+    auto start = high_resolution_clock::now();
+
+    int numVertices = indexToTile.size();
+    int src = source->index;
+    int dest = destin->index;
+    auto greater = std::greater<pair<pair<int, int>, int>>();
+    nodesExpanded = 0;
+
+    if (src != incSource || dest != incDest || incG.size() != numVertices)
+    {
+        incSource = src;
+        incDest = dest;
+        incG.assign(numVertices, incInfinity);
+        incRhs.assign(numVertices, incInfinity);
+        incOpen.clear();
+        incChanged.clear();
+        incRhs[src] = 0;
+        incOpen.push_back({incKey(src), src});
+    }
+
+    else
+    {
+        for (int u: incChanged)
+        {
+            incUpdateTile(u);
+
+            for (int e = csrOffsets[u]; e < csrOffsets[u + 1]; e++)
+                incUpdateTile(csrTargets[e]);
+        }
+
+        incChanged.clear();
+    }
+
+    // Settle tiles in key order until the destination is consistent and every tile with a key up to the
+    // destination's is settled.  Settling ties as well guarantees that every tile the path is read back from below
+    // is consistent.
+    while (!incOpen.empty())
+    {
+        pair<pair<int, int>, int> top = incOpen.front();
+        int u = top.second;
+
+        if (incG[u] == incRhs[u] || top.first != incKey(u))
+        {
+            std::pop_heap(incOpen.begin(), incOpen.end(), greater);
+            incOpen.pop_back();
+            continue;
+        }
+
+        if (top.first > incKey(dest) && incG[dest] == incRhs[dest])
+            break;
+
+        std::pop_heap(incOpen.begin(), incOpen.end(), greater);
+        incOpen.pop_back();
+        nodesExpanded++;
+
+        // Overconsistent: the new distance is settled.  Underconsistent: the old distance no longer holds, so it is
+        // dropped and the tile is re-examined along with its neighbors.
+        if (incG[u] > incRhs[u])
+            incG[u] = incRhs[u];
+
+        else
+        {
+            incG[u] = incInfinity;
+            incUpdateTile(u);
+        }
+
+        for (int e = csrOffsets[u]; e < csrOffsets[u + 1]; e++)
+            incUpdateTile(csrTargets[e]);
+    }
+
+    // The path is written into the search workspace's parent array, which is kept by the board, so a repair costs
+    // nothing beyond the tiles it touched and the tiles of the path.  Only the path's entries are written.
+    beginSearch();
+    int* p = workParent.data();
+
+    if (incG[dest] >= incInfinity)
+        p[dest] = -1;
+
+    else
+    {
+        // Walk back from the destination, each step to a free neighbor one move closer to the source.
+        int u = dest;
+
+        while (u != src)
+        {
+            int next = -1;
+
+            for (int e = csrOffsets[u]; e < csrOffsets[u + 1] && next == -1; e++)
+            {
+                int v = csrTargets[e];
+
+                if (!obstacleMask[v] && incG[v] == incG[u] - 1)
+                    next = v;
+            }
+
+            // Every reached tile but the source has such a neighbor.  Report no path rather than a broken one.
+            if (next == -1)
+            {
+                p[dest] = -1;
+                break;
+            }
+
+            p[u] = next;
+            u = next;
+        }
+    }
+
+    auto stop = high_resolution_clock::now();
+    duration = stop - start;
+
+    return p;
+}
+
+// Barrier used by shortestPathParallel to keep its threads on the same BFS level.  Threads spin (yielding) rather
+// than sleep, since a level on a board of this size only takes microseconds.
+class SpinBarrier
+{
+    private:
+        int count; // Number of threads that wait at the barrier.
+        std::atomic<int> waiting; // Number of threads that have arrived in the current round.
+        std::atomic<int> round; // Incremented each time all threads have arrived.
+
+    public:
+        SpinBarrier(int n) : count(n), waiting(0), round(0) {}
+
+        void wait()
+        {
+            int current = round.load();
+
+            if (waiting.fetch_add(1) + 1 == count)
+            {
+                waiting.store(0);
+                round.fetch_add(1);
+            }
+
+            else
+            {
+                while (round.load() == current)
+                    std::this_thread::yield();
+            }
+        }
+};
+
+bool Board::jpsFree(int i, int j)
+{
+    /*
+    Jump point search helper.  True if {i, j} is on the board and not an obstacle.
+    */
+    return i >= 0 && i < tilesY && j >= 0 && j < tilesX && !obstacleMask[i * tilesX + j];
+}
+
+int Board::jpsJump(int i, int j, int di, int dj, int dest)
+{
+    /*
+    Jump point search helper.  Steps from {i, j} in direction {di, dj} until it reaches the destination or a jump
+    point: a tile with a forced neighbor, or (moving diagonally) a tile from which a straight jump along either
+    component of the direction finds one.  Returns the index of that tile, or -1 if an obstacle or the edge of the
+    board is reached first.  Every move costs 1, and diagonal moves may cut corners, as in insertEdges.
+    */
+    while (true)
+    {
+        i += di;
+        j += dj;
+        jpsScanned++;
+
+        if (!jpsFree(i, j))
+            return -1;
+
+        int u = i * tilesX + j;
+
+        if (u == dest)
+            return u;
+
+        if (di != 0 && dj != 0)
+        {
+            // Diagonal: a blocked tile behind either side forces the move that goes around it.
+            if ((!jpsFree(i - di, j) && jpsFree(i - di, j + dj)) || (!jpsFree(i, j - dj) && jpsFree(i + di, j - dj)))
+                return u;
+
+            if (jpsJump(i, j, di, 0, dest) != -1 || jpsJump(i, j, 0, dj, dest) != -1)
+                return u;
+        }
+
+        else if (di != 0)
+        {
+            // Vertical: a blocked tile to the left or right forces the diagonal move past it.
+            if ((!jpsFree(i, j - 1) && jpsFree(i + di, j - 1)) || (!jpsFree(i, j + 1) && jpsFree(i + di, j + 1)))
+                return u;
+        }
+
+        else
+        {
+            // Horizontal: a blocked tile above or below forces the diagonal move past it.
+            if ((!jpsFree(i - 1, j) && jpsFree(i - 1, j + dj)) || (!jpsFree(i + 1, j) && jpsFree(i + 1, j + dj)))
+                return u;
+        }
+    }
+}
+
+int* Board::shortestPathJPS()
+{
+    /*
+    Jump point search: A* with the Chebyshev distance as the heuristic, where each tile's neighbors are pruned down
+    to those that no equally short path could reach without going through the tile, and each remaining direction
+    is followed (by jpsJump) to the next jump point instead of one tile at a time.  Only jump points go on the open
+    list, so nodesExpanded counts jump points; jpsScanned counts the tiles stepped over by the jumps.  The path
+    between consecutive jump points is a straight or diagonal line, which is filled back in to give the usual p.
+    */
+    auto start = high_resolution_clock::now();
+
+    int numVertices = indexToTile.size();
+    int src = source->index;
+    int dest = destin->index;
+    int destI = dest / tilesX;
+    int destJ = dest % tilesX;
+    vector<int> g(numVertices, incInfinity);
+    vector<int> parent(numVertices, -1);
+    vector<char> closed(numVertices, 0);
+    // Min-heap of {{f, g}, tile}.  Entries whose g is out of date are skipped.
+    std::priority_queue<pair<pair<int, int>, int>, vector<pair<pair<int, int>, int>>, std::greater<pair<pair<int, int>, int>>> open;
+    nodesExpanded = 0;
+    jpsScanned = 0;
+    g[src] = 0;
+    open.push({{std::max(std::abs(src / tilesX - destI), std::abs(src % tilesX - destJ)), 0}, src});
+
+    while (!open.empty())
+    {
+        int u = open.top().second;
+        open.pop();
+
+        if (closed[u])
+            continue;
+
+        closed[u] = true;
+        nodesExpanded++;
+
+        if (u == dest)
+            break;
+
+        int i = u / tilesX;
+        int j = u % tilesX;
+        // Directions to jump in from u: all 8 from the source, otherwise the natural and forced neighbors for the
+        // direction u was reached in.
+        int dirs[8][2];
+        int numDirs = 0;
+
+        if (u == src)
+        {
+            for (int di = -1; di <= 1; di++)
+            {
+                for (int dj = -1; dj <= 1; dj++)
+                {
+                    if (di != 0 || dj != 0)
+                    {
+                        dirs[numDirs][0] = di;
+                        dirs[numDirs++][1] = dj;
+                    }
+                }
+            }
+        }
+
+        else
+        {
+            int di = (i > parent[u] / tilesX) - (i < parent[u] / tilesX);
+            int dj = (j > parent[u] % tilesX) - (j < parent[u] % tilesX);
+            dirs[numDirs][0] = di;
+            dirs[numDirs++][1] = dj;
+
+            if (di != 0 && dj != 0)
+            {
+                dirs[numDirs][0] = di;
+                dirs[numDirs++][1] = 0;
+                dirs[numDirs][0] = 0;
+                dirs[numDirs++][1] = dj;
+
+                if (!jpsFree(i - di, j))
+                {
+                    dirs[numDirs][0] = -di;
+                    dirs[numDirs++][1] = dj;
+                }
+
+                if (!jpsFree(i, j - dj))
+                {
+                    dirs[numDirs][0] = di;
+                    dirs[numDirs++][1] = -dj;
+                }
+            }
+
+            else if (di != 0)
+            {
+                for (int side = -1; side <= 1; side += 2)
+                {
+                    if (!jpsFree(i, j + side))
+                    {
+                        dirs[numDirs][0] = di;
+                        dirs[numDirs++][1] = side;
+                    }
+                }
+            }
+
+            else
+            {
+                for (int side = -1; side <= 1; side += 2)
+                {
+                    if (!jpsFree(i + side, j))
+                    {
+                        dirs[numDirs][0] = side;
+                        dirs[numDirs++][1] = dj;
+                    }
+                }
+            }
+        }
+
+        for (int d = 0; d < numDirs; d++)
+        {
+            int v = jpsJump(i, j, dirs[d][0], dirs[d][1], dest);
+
+            if (v == -1 || closed[v])
+                continue;
+
+            int vI = v / tilesX;
+            int vJ = v % tilesX;
+            int newG = g[u] + std::max(std::abs(vI - i), std::abs(vJ - j));
+
+            if (newG < g[v])
+            {
+                g[v] = newG;
+                parent[v] = u;
+                open.push({{newG + std::max(std::abs(vI - destI), std::abs(vJ - destJ)), newG}, v});
+            }
+        }
+    }
+
+    int* p = new int[numVertices] {-1};
+
+    if (!closed[dest])
+        p[dest] = -1;
+
+    else
+    {
+        // Fill in the tiles between each jump point and its parent, one move at a time.
+        for (int v = dest; v != src; v = parent[v])
+        {
+            int u = parent[v];
+            int di = (u / tilesX > v / tilesX) - (u / tilesX < v / tilesX);
+            int dj = (u % tilesX > v % tilesX) - (u % tilesX < v % tilesX);
+
+            for (int w = v; w != u; w += di * tilesX + dj)
+                p[w] = w + di * tilesX + dj;
+        }
+    }
+
+    auto stop = high_resolution_clock::now();
+    duration = stop - start;
+
+    return p;
+}
+
+int* Board::shortestPathAStar()
+{
+    /*
+    A* on the CSR arrays, with the Chebyshev distance (the number of king moves on an empty board) as the
+    heuristic.  It is exact on an empty board and never overestimates, and since every move costs 1, f = g + h
+    never decreases along a path.  f values are small integers, so the open list is an array of buckets indexed by
+    f rather than a heap: the lowest non-empty bucket is found by moving a cursor forward, never back.  Each
+    bucket is a stack, so among equal f the newest, deepest entry is taken first.  Entries of tiles already
+    closed are skipped.
+    */
+    auto start = high_resolution_clock::now();
+
+    int numVertices = indexToTile.size();
+    int src = source->index;
+    int dest = destin->index;
+    int destI = dest / tilesX;
+    int destJ = dest % tilesX;
+    const int* offsets = csrOffsets.data();
+    const int* targets = csrTargets.data();
+    const char* obst = obstacleMask.data();
+    int* g = new int[numVertices];
+    bool* closed = new bool[numVertices] {false};
+    int* p = new int[numVertices] {-1};
+    std::fill(g, g + numVertices, incInfinity);
+    nodesExpanded = 0;
+
+    // The buckets keep their capacity from one search to the next.
+    for (vector<int>& bucket: astarBuckets)
+        bucket.clear();
+
+    auto h = [&](int u) { return std::max(std::abs(u / tilesX - destI), std::abs(u % tilesX - destJ)); };
+    int f = h(src);
+    g[src] = 0;
+
+    if (astarBuckets.size() <= f)
+        astarBuckets.resize(f + 1);
+
+    astarBuckets[f].push_back(src);
+
+    while (f < astarBuckets.size())
+    {
+        if (astarBuckets[f].empty())
+        {
+            f++;
+            continue;
+        }
+
+        int u = astarBuckets[f].back();
+        astarBuckets[f].pop_back();
+
+        if (closed[u])
+            continue;
+
+        closed[u] = true;
+        nodesExpanded++;
+
+        if (u == dest)
+            break;
+
+        for (int e = offsets[u]; e < offsets[u + 1]; e++)
+        {
+            int v = targets[e];
+
+            if (!obst[v] && !closed[v] && g[u] + 1 < g[v])
+            {
+                g[v] = g[u] + 1;
+                p[v] = u;
+                int fv = g[v] + h(v);
+
+                if (astarBuckets.size() <= fv)
+                    astarBuckets.resize(fv + 1);
+
+                astarBuckets[fv].push_back(v);
+            }
+        }
+    }
+
+    if (!closed[dest])
+        p[dest] = -1;
+
+    auto stop = high_resolution_clock::now();
+    duration = stop - start;
+
+    delete[] g;
+    g = nullptr;
+    delete[] closed;
+    closed = nullptr;
+
+    return p;
+}
+
+int* Board::shortestPathWeighted()
+{
+    /*
+    Finds the cheapest path from the source to the destination, where entering a tile costs its terrain cost.  Costs
+    are small integers, so no heap is needed: with every cost 0 or 1 the search is 0-1 BFS, otherwise Dial's
+    algorithm.  Both take O(V + E + C) time, C being the largest cost, instead of the O(E log V) of Dijkstra with a
+    heap.  Every other engine ignores terrain and counts moves.
+    */
+    auto start = high_resolution_clock::now();
+
+    // The distances live beside the search workspace and are only read where workVisited is current.
+    if (dialDist.size() != indexToTile.size())
+        dialDist.assign(indexToTile.size(), 0);
+
+    int* p = heavyTiles == 0 ? shortestPathZeroOne() : shortestPathDial();
+
+    auto stop = high_resolution_clock::now();
+    duration = stop - start;
+
+    return p;
+}
+
+int* Board::shortestPathZeroOne()
+{
+    /*
+    0-1 BFS from the source.  The deque of 0-1 BFS is kept as two queues: tiles at the current cost, in workQueue,
+    and tiles at one more, in the first bucket.  A tile entered at no cost joins the current queue; a tile entered at
+    cost 1 waits in the bucket until the current queue runs out.  A tile whose cost drops after it was put in the
+    bucket is skipped when the bucket is moved over, so each tile is taken off the queue once.
+    */
+    beginSearch();
+    int* q = workQueue.data();
+    int* p = workParent.data();
+    int* dist = dialDist.data();
+    uint32_t* visited = workVisited.data();
+    uint32_t epoch = workEpoch;
+    const int* offsets = csrOffsets.data();
+    const int* targets = csrTargets.data();
+    const char* obst = obstacleMask.data();
+    const unsigned char* cost = terrainCost.data();
+    vector<int>& next = dialBuckets[0];
+    int src = source->index;
+    int dest = destin->index;
+    int qHead = 0;
+    int qTail = 0;
+    int d = 0;
+    long long edges = 0;
+    int peak = 1;
+    bool endFound = false;
+    next.clear();
+    visited[src] = epoch;
+    dist[src] = 0;
+    q[qTail++] = src;
+
+    while (qHead < qTail && !endFound)
+    {
+        while (qHead < qTail)
+        {
+            int u = q[qHead++];
+
+            if (u == dest)
+            {
+                endFound = true;
+                break;
+            }
+
+            for (int e = offsets[u]; e < offsets[u + 1]; e++)
+            {
+                int v = targets[e];
+                edges++;
+
+                if (obst[v] || (visited[v] == epoch && dist[v] <= d + cost[v]))
+                    continue;
+
+                visited[v] = epoch;
+                dist[v] = d + cost[v];
+                p[v] = u;
+
+                if (cost[v] == 0)
+                    q[qTail++] = v;
+
+                else
+                    next.push_back(v);
+            }
+
+            peak = std::max<int>(peak, qTail - qHead + next.size());
+        }
+
+        // Start on the next cost.  Tiles reached at no cost from the queue just emptied were queued there already.
+        d++;
+
+        for (int v: next)
+        {
+            if (dist[v] == d)
+                q[qTail++] = v;
+        }
+
+        next.clear();
+    }
+
+    queryStats.edgesScanned = edges;
+    queryStats.peakQueue = peak;
+    nodesExpanded = qHead;
+    pathCost = endFound ? dist[dest] : -1;
+
+    if (!endFound)
+        p[dest] = -1;
+
+    return p;
+}
+
+int* Board::shortestPathDial()
+{
+    /*
+    Dial's algorithm: Dijkstra's algorithm with the heap replaced by maxTerrainCost + 1 buckets, used in a circle.
+    Tiles at cost d wait in bucket d % (maxTerrainCost + 1), and since no move costs more than maxTerrainCost,
+    every waiting tile's cost is within that many of the bucket being emptied, so no two costs share a bucket.  The
+    buckets are emptied in order of cost.  When a tile's cost drops, it is put in its new bucket and its old entry is
+    left behind, to be skipped when its bucket comes round.
+    */
+    beginSearch();
+    int* p = workParent.data();
+    int* dist = dialDist.data();
+    uint32_t* visited = workVisited.data();
+    uint32_t epoch = workEpoch;
+    const int* offsets = csrOffsets.data();
+    const int* targets = csrTargets.data();
+    const char* obst = obstacleMask.data();
+    const unsigned char* cost = terrainCost.data();
+    int src = source->index;
+    int dest = destin->index;
+    long long edges = 0;
+    long long waiting = 1; // Entries in all buckets, including left behind ones.
+    long long peak = 1;
+    bool endFound = false;
+    nodesExpanded = 0;
+
+    // The buckets keep their capacity from one search to the next.
+    for (vector<int>& bucket: dialBuckets)
+        bucket.clear();
+
+    visited[src] = epoch;
+    dist[src] = 0;
+    dialBuckets[0].push_back(src);
+
+    for (int d = 0; waiting > 0 && !endFound; d++)
+    {
+        // Tiles entered at no cost join the bucket being emptied, so it is walked by position rather than by iterator.
+        vector<int>& bucket = dialBuckets[d % (maxTerrainCost + 1)];
+
+        for (int k = 0; k < bucket.size(); k++)
+        {
+            int u = bucket[k];
+            waiting--;
+
+            if (dist[u] != d)
+                continue;
+
+            nodesExpanded++;
+
+            if (u == dest)
+            {
+                endFound = true;
+                break;
+            }
+
+            for (int e = offsets[u]; e < offsets[u + 1]; e++)
+            {
+                int v = targets[e];
+                edges++;
+
+                if (obst[v] || (visited[v] == epoch && dist[v] <= d + cost[v]))
+                    continue;
+
+                visited[v] = epoch;
+                dist[v] = d + cost[v];
+                p[v] = u;
+                dialBuckets[dist[v] % (maxTerrainCost + 1)].push_back(v);
+                waiting++;
+            }
+
+            peak = std::max(peak, waiting);
+        }
+
+        bucket.clear();
+    }
+
+    queryStats.edgesScanned = edges;
+    queryStats.peakQueue = peak;
+    pathCost = endFound ? dist[dest] : -1;
+
+    if (!endFound)
+        p[dest] = -1;
+
+    return p;
+}
+
+void Board::hpaClusterBFS(int c, int start, vector<int>& dist, vector<int>& parent)
+{
+    /*
+    Hierarchical engine helper.  BFS from tile start that never leaves cluster c.  dist and parent are indexed by
+    the tile's position inside the cluster, (i % hpaClusterSize) * hpaClusterSize + j % hpaClusterSize, and hold
+    -1 for tiles that can't be reached.  parent holds tile indices.
+    */
+    int i0 = c / hpaClustersX * hpaClusterSize;
+    int j0 = c % hpaClustersX * hpaClusterSize;
+    int i1 = std::min(i0 + hpaClusterSize, tilesY);
+    int j1 = std::min(j0 + hpaClusterSize, tilesX);
+    int q[hpaClusterSize * hpaClusterSize];
+    int qHead = 0;
+    int qTail = 0;
+    dist.assign(hpaClusterSize * hpaClusterSize, -1);
+    parent.assign(hpaClusterSize * hpaClusterSize, -1);
+    dist[(start / tilesX - i0) * hpaClusterSize + start % tilesX - j0] = 0;
+    q[qTail++] = start;
+
+    while (qHead < qTail)
+    {
+        int u = q[qHead++];
+        int ui = u / tilesX;
+        int uj = u % tilesX;
+        int du = dist[(ui - i0) * hpaClusterSize + uj - j0];
+        nodesExpanded++;
+
+        for (int vi = std::max(ui - 1, i0); vi <= std::min(ui + 1, i1 - 1); vi++)
+        {
+            for (int vj = std::max(uj - 1, j0); vj <= std::min(uj + 1, j1 - 1); vj++)
+            {
+                int local = (vi - i0) * hpaClusterSize + vj - j0;
+
+                if (dist[local] == -1 && !obstacleMask[vi * tilesX + vj])
+                {
+                    dist[local] = du + 1;
+                    parent[local] = u;
+                    q[qTail++] = vi * tilesX + vj;
+                }
+            }
+        }
+    }
+}
+
+void Board::hpaBorder(int c1, int c2, vector<pair<int, int>>& out)
+{
+    /*
+    Hierarchical engine helper.  Appends the transitions between neighboring clusters c1 and c2 to out, as
+    {tile in c1, tile in c2}.  Along a shared side, each run of free tiles facing free tiles gets a transition in
+    its middle, or one at each end if it is at least 6 long.  A diagonal crossing next to no such run gets its own
+    transition, as does the corner between diagonal neighbors if both corner tiles are free.  Every crossing is
+    then connected, inside both clusters, to a transition, so the abstract graph has a path whenever the board
+    does.  The result only depends on the tiles along the border, so it comes out the same from either side.
+    */
+    int ci1 = c1 / hpaClustersX;
+    int cj1 = c1 % hpaClustersX;
+    int di = c2 / hpaClustersX - ci1;
+    int dj = c2 % hpaClustersX - cj1;
+    auto isFree = [&](int i, int j) { return !obstacleMask[i * tilesX + j]; };
+
+    // Corner between diagonal neighbors.
+    if (di != 0 && dj != 0)
+    {
+        int i = di > 0 ? std::min((ci1 + 1) * hpaClusterSize, tilesY) - 1 : ci1 * hpaClusterSize;
+        int j = dj > 0 ? std::min((cj1 + 1) * hpaClusterSize, tilesX) - 1 : cj1 * hpaClusterSize;
+
+        if (isFree(i, j) && isFree(i + di, j + dj))
+            out.push_back({i * tilesX + j, (i + di) * tilesX + j + dj});
+
+        return;
+    }
+
+    // Side.  Position k runs along the border; tile(k, 0) is in c1 and tile(k, 1) is in c2.
+    int first = di != 0 ? cj1 * hpaClusterSize : ci1 * hpaClusterSize;
+    int last = di != 0 ? std::min((cj1 + 1) * hpaClusterSize, tilesX) - 1 : std::min((ci1 + 1) * hpaClusterSize, tilesY) - 1;
+    int line = 0;
+
+    if (di > 0)
+        line = std::min((ci1 + 1) * hpaClusterSize, tilesY) - 1;
+    else if (di < 0)
+        line = ci1 * hpaClusterSize;
+    else if (dj > 0)
+        line = std::min((cj1 + 1) * hpaClusterSize, tilesX) - 1;
+    else
+        line = cj1 * hpaClusterSize;
+
+    auto tile = [&](int k, int side) { return di != 0 ? (line + side * di) * tilesX + k : k * tilesX + line + side * dj; };
+    auto straight = [&](int k) { return k >= first && k <= last && !obstacleMask[tile(k, 0)] && !obstacleMask[tile(k, 1)]; };
+
+    for (int k = first; k <= last; k++)
+    {
+        if (straight(k))
+        {
+            int end = k;
+
+            while (straight(end + 1))
+                end++;
+
+            if (end - k + 1 >= 6)
+            {
+                out.push_back({tile(k, 0), tile(k, 1)});
+                out.push_back({tile(end, 0), tile(end, 1)});
+            }
+
+            else
+                out.push_back({tile((k + end) / 2, 0), tile((k + end) / 2, 1)});
+
+            k = end;
+        }
+
+        else if (!obstacleMask[tile(k, 0)])
+        {
+            for (int step = -1; step <= 1; step += 2)
+            {
+                int m = k + step;
+
+                if (m >= first && m <= last && !straight(m) && !obstacleMask[tile(m, 1)])
+                    out.push_back({tile(k, 0), tile(m, 1)});
+            }
+        }
+    }
+}
+
+void Board::hpaMarkDirty(int u)
+{
+    /*
+    Hierarchical engine helper.  Marks the cluster of tile u for rebuilding.  A tile on the cluster's edge can also
+    change the transitions to the neighboring clusters, so they are marked as well.
+    */
+    int i = u / tilesX;
+    int j = u % tilesX;
+    int ci = i / hpaClusterSize;
+    int cj = j / hpaClusterSize;
+    bool onEdge = i % hpaClusterSize == 0 || i % hpaClusterSize == hpaClusterSize - 1 || i == tilesY - 1 || j % hpaClusterSize == 0 || j % hpaClusterSize == hpaClusterSize - 1 || j == tilesX - 1;
+
+    for (int ni = std::max(ci - 1, 0); ni <= std::min(ci + 1, hpaClustersY - 1); ni++)
+    {
+        for (int nj = std::max(cj - 1, 0); nj <= std::min(cj + 1, hpaClustersX - 1); nj++)
+        {
+            if (onEdge || (ni == ci && nj == cj))
+                hpaClusters[ni * hpaClustersX + nj].dirty = true;
+        }
+    }
+}
+
+void Board::hpaRebuildCluster(int c)
+{
+    /*
+    Hierarchical engine helper.  Recomputes the transitions of cluster c with its (up to) 8 neighbors, and the
+    distances inside the cluster between every pair of its transition tiles.
+    */
+    HpaCluster& cluster = hpaClusters[c];
+
+    for (int u: cluster.nodes)
+        hpaNodeSlot[u] = -1;
+
+    cluster.nodes.clear();
+    cluster.partners.clear();
+    int ci = c / hpaClustersX;
+    int cj = c % hpaClustersX;
+    vector<pair<int, int>> transitions;
+
+    for (int ni = std::max(ci - 1, 0); ni <= std::min(ci + 1, hpaClustersY - 1); ni++)
+    {
+        for (int nj = std::max(cj - 1, 0); nj <= std::min(cj + 1, hpaClustersX - 1); nj++)
+        {
+            if (ni != ci || nj != cj)
+                hpaBorder(c, ni * hpaClustersX + nj, transitions);
+        }
+    }
+
+    for (const pair<int, int>& t: transitions)
+    {
+        if (hpaNodeSlot[t.first] == -1)
+        {
+            hpaNodeSlot[t.first] = cluster.nodes.size();
+            cluster.nodes.push_back(t.first);
+            cluster.partners.push_back({});
+        }
+
+        cluster.partners[hpaNodeSlot[t.first]].push_back(t.second);
+    }
+
+    int n = cluster.nodes.size();
+    int i0 = ci * hpaClusterSize;
+    int j0 = cj * hpaClusterSize;
+    cluster.dist.assign(n * n, -1);
+    vector<int> dist;
+    vector<int> parent;
+
+    for (int a = 0; a < n; a++)
+    {
+        hpaClusterBFS(c, cluster.nodes[a], dist, parent);
+
+        for (int b = 0; b < n; b++)
+            cluster.dist[a * n + b] = dist[(cluster.nodes[b] / tilesX - i0) * hpaClusterSize + cluster.nodes[b] % tilesX - j0];
+    }
+
+    cluster.dirty = false;
+}
+
+int* Board::shortestPathHPA()
+{
+    /*
+    Hierarchical pathfinding (HPA*).  The board is split into hpaClusterSize x hpaClusterSize clusters, and the
+    abstract graph has a vertex for every transition tile (see hpaBorder), with an edge of cost 1 across each
+    transition and an edge inside each cluster for every pair of its transition tiles that are connected, costing
+    their distance inside the cluster.  Clusters whose tiles changed are rebuilt first, and only they are.
+    The source and destination are connected to the transition tiles of their own clusters by a BFS inside each,
+    then A* (Chebyshev heuristic) runs on the abstract graph, and finally each abstract edge of the route is
+    refined back into tiles with a BFS inside its cluster.  Paths inside a cluster are exact, but the route
+    between clusters has to pass through transition tiles, so the path can be a few moves longer than the
+    shortest.  nodesExpanded counts abstract vertices plus the tiles dequeued by all of the cluster BFSs,
+    including rebuilds.
+    */
+    auto start = high_resolution_clock::now();
+
+    int numVertices = indexToTile.size();
+    int src = source->index;
+    int dest = destin->index;
+    int destI = dest / tilesX;
+    int destJ = dest % tilesX;
+    auto clusterOf = [&](int u) { return u / tilesX / hpaClusterSize * hpaClustersX + u % tilesX / hpaClusterSize; };
+    auto local = [&](int u) { return u / tilesX % hpaClusterSize * hpaClusterSize + u % tilesX % hpaClusterSize; };
+    nodesExpanded = 0;
+    hpaRebuilt = 0;
+
+    for (int c = 0; c < hpaClusters.size(); c++)
+    {
+        if (hpaClusters[c].dirty)
+        {
+            hpaRebuildCluster(c);
+            hpaRebuilt++;
+        }
+    }
+
+    int srcCluster = clusterOf(src);
+    int destCluster = clusterOf(dest);
+    vector<int> srcDist;
+    vector<int> destDist;
+    vector<int> parent;
+    hpaClusterBFS(srcCluster, src, srcDist, parent);
+    hpaClusterBFS(destCluster, dest, destDist, parent);
+
+    // A* on the abstract graph.  g and the parents live in board-sized arrays, and only the touched entries are
+    // reset afterwards, so the search costs time in proportion to the abstract graph and not the board.
+    if (hpaG.size() != numVertices)
+    {
+        hpaG.assign(numVertices, incInfinity);
+        hpaParent.assign(numVertices, -1);
+    }
+
+    vector<int> touched;
+    std::priority_queue<pair<int, int>, vector<pair<int, int>>, std::greater<pair<int, int>>> open;
+    auto relax = [&](int u, int v, int cost)
+    {
+        if (hpaG[u] + cost < hpaG[v])
+        {
+            if (hpaG[v] == incInfinity)
+                touched.push_back(v);
+
+            hpaG[v] = hpaG[u] + cost;
+            hpaParent[v] = u;
+            open.push({hpaG[v] + std::max(std::abs(v / tilesX - destI), std::abs(v % tilesX - destJ)), v});
+        }
+    };
+
+    hpaG[src] = 0;
+    touched.push_back(src);
+    open.push({0, src});
+
+    while (!open.empty())
+    {
+        int f = open.top().first;
+        int u = open.top().second;
+        open.pop();
+
+        if (f > hpaG[u] + std::max(std::abs(u / tilesX - destI), std::abs(u % tilesX - destJ)))
+            continue;
+
+        nodesExpanded++;
+
+        if (u == dest)
+            break;
+
+        int c = clusterOf(u);
+
+        if (u == src)
+        {
+            for (int w: hpaClusters[c].nodes)
+            {
+                if (srcDist[local(w)] >= 0)
+                    relax(u, w, srcDist[local(w)]);
+            }
+        }
+
+        if (hpaNodeSlot[u] != -1)
+        {
+            const HpaCluster& cluster = hpaClusters[c];
+            int n = cluster.nodes.size();
+            int a = hpaNodeSlot[u];
+
+            for (int b = 0; b < n; b++)
+            {
+                if (b != a && cluster.dist[a * n + b] >= 0)
+                    relax(u, cluster.nodes[b], cluster.dist[a * n + b]);
+            }
+
+            for (int w: cluster.partners[a])
+                relax(u, w, 1);
+        }
+
+        if (c == destCluster && destDist[local(u)] >= 0)
+            relax(u, dest, destDist[local(u)]);
+    }
+
+    int* p = new int[numVertices] {-1};
+
+    if (hpaG[dest] == incInfinity)
+        p[dest] = -1;
+
+    else
+    {
+        // Refine each abstract edge into tiles.  Across a transition the two tiles are neighbors; inside a cluster
+        // a BFS from the edge's first tile gives the moves to its second.
+        vector<int> dist;
+
+        for (int v = dest; v != src; v = hpaParent[v])
+        {
+            int u = hpaParent[v];
+
+            if (clusterOf(u) != clusterOf(v))
+                p[v] = u;
+
+            else
+            {
+                hpaClusterBFS(clusterOf(u), u, dist, parent);
+
+                for (int w = v; w != u; w = p[w])
+                    p[w] = parent[local(w)];
+            }
+        }
+    }
+
+    for (int u: touched)
+    {
+        hpaG[u] = incInfinity;
+        hpaParent[u] = -1;
+    }
+
+    auto stop = high_resolution_clock::now();
+    duration = stop - start;
+
+    return p;
+}
+
+void Board::buildDistanceField(int src)
+{
+    /*
+    Runs one full BFS from src on the CSR arrays, with no destination to stop at, and keeps the distance and parent
+    of every tile in fieldDist and fieldParent.  The path from src to any tile can then be read back from
+    fieldParent without searching again, until the source or an obstacle changes (see clearDistanceField).
+    */
+    auto start = high_resolution_clock::now();
+
+    int numVertices = indexToTile.size();
+    const int* offsets = csrOffsets.data();
+    const int* targets = csrTargets.data();
+    const char* obst = obstacleMask.data();
+    fieldDist.assign(numVertices, -1);
+    fieldParent.assign(numVertices, -1);
+    // The queue is only needed while building, so the distance field itself is all that is kept.
+    vector<int> q(numVertices);
+    int qHead = 0;
+    int qTail = 0;
+    fieldDist[src] = 0;
+    q[qTail++] = src;
+
+    while (qHead < qTail)
+    {
+        int u = q[qHead++];
+
+        for (int e = offsets[u]; e < offsets[u + 1]; e++)
+        {
+            int v = targets[e];
+
+            if (fieldDist[v] == -1 && !obst[v])
+            {
+                fieldDist[v] = fieldDist[u] + 1;
+                fieldParent[v] = u;
+                q[qTail++] = v;
+            }
+        }
+    }
+
+    fieldSource = src;
+    fieldReached = qTail;
+    fieldMaxDist = fieldDist[q[qTail - 1]];
+    nodesExpanded = qTail;
+
+    auto stop = high_resolution_clock::now();
+    fieldDuration = stop - start;
+
+    if (heatMap)
+        paintHeatMap();
+}
+
+int* Board::shortestPathField()
+{
+    /*
+    Finds the shortest path from the distance field of the source, building the field first if the source or the
+    obstacles changed since it was built.  Otherwise only the path itself is read back, which takes time
+    proportional to its length, and only the path's entries of p are written.
+    */
+    auto start = high_resolution_clock::now();
+    nodesExpanded = 0;
+
+    if (fieldSource != source->index)
+        buildDistanceField(source->index);
+
+    int dest = destin->index;
+    int* p = new int[indexToTile.size()];
+
+    if (fieldDist[dest] == -1)
+        p[dest] = -1;
+
+    for (int u = dest; u != fieldSource && fieldDist[u] != -1; u = fieldParent[u])
+        p[u] = fieldParent[u];
+
+    auto stop = high_resolution_clock::now();
+    duration = stop - start;
+
+    return p;
+}
+
+sf::Color Board::restingColor(int u)
+{
+    /*
+    Returns the color of a free tile that is not on a path: its heat map color when the heat map is showing and the
+    tile was reached, otherwise its terrain color.  Path tiles return to this color when the path is cleared.
+    */
+    if (!heatPainted || fieldDist[u] <= 0)
+        return terrainColor(u);
+
+    // Near tiles are bright teal, fading to dark blue at the farthest reached tile.
+    float t = float(fieldDist[u]) / std::max(1, fieldMaxDist);
+    return sf::Color(0, 40 + 150 * (1 - t), 90 + 110 * t);
+}
+
+sf::Color Board::terrainColor(int u)
+{
+    /*
+    Returns the color of a free tile's terrain: black on plain ground, dark green on a preferred lane (cost 0), and
+    brown for slow ground, lighter the more it costs.
+    */
+    int cost = terrainCost[u];
+
+    if (cost == 1)
+        return sf::Color::Black;
+
+    if (cost == 0)
+        return sf::Color(0, 90, 30);
+
+    return sf::Color(60 + 20 * cost, 40 + 8 * cost, 10);
+}
+
+uint64_t Board::terrainKey(int u, int cost)
+{
+    /*
+    Returns what tile u adds to terrainHash when its terrain has the given cost: nothing on plain ground, otherwise
+    its tile key times an odd number that depends on the cost, so that paths cached for one terrain layout are not
+    returned for another.
+    */
+    return cost == 1 ? 0 : tileKeys[u] * uint64_t(2 * cost + 3);
+}
+
+void Board::setTerrain(Tile* t, int cost)
+{
+    /*
+    Sets the cost of entering tile t.  heavyTiles, terrainTiles and terrainHash are kept up to date, and a free tile other than
+    the source and destination is recolored.  The terrain of an obstacle is kept, and shows again once the obstacle
+    is removed.
+    */
+    int u = t->index;
+
+    if (terrainCost[u] == cost)
+        return;
+
+    heavyTiles += (cost > 1) - (terrainCost[u] > 1);
+    terrainTiles += (cost != 1) - (terrainCost[u] != 1);
+    terrainHash ^= terrainKey(u, terrainCost[u]) ^ terrainKey(u, cost);
+    terrainCost[u] = cost;
+
+    if (!obstacleMask[u] && t != source && t != destin)
+        t->setTileColor(restingColor(u));
+}
+
+void Board::paintHeatMap()
+{
+    /*
+    Colors every free tile (other than the source, destination and path tiles) by its distance from the source, or
+    back to black when the heat map is switched off.
+    */
+    heatPainted = heatMap && fieldSource != -1;
+    set<Tile*> onPath(hoverPath.begin(), hoverPath.end());
+
+    if (shortestPath.size() > 0 && shortestPath[0] != nullptr)
+        onPath.insert(shortestPath.begin(), shortestPath.end());
+
+    for (Tile* t: indexToTile)
+    {
+        if (!obstacleMask[t->index] && t != source && t != destin && !onPath.count(t))
+            t->setTileColor(restingColor(t->index));
+    }
+}
+
+void Board::showHoverPath(int index)
+{
+    /*
+    Shows the path from the source to the tile at index, read back from the distance field, in place of the
+    previous hover path.  The field is built first if needed.  Writes the field and path statistics to resultLines.
+    */
+    if (index == hoverIndex)
+        return;
+
+    clearHoverPath();
+    bool fieldBuilt = fieldSource != source->index;
+
+    if (fieldBuilt)
+        buildDistanceField(source->index);
+
+    auto start = high_resolution_clock::now();
+    hoverIndex = index;
+
+    if (fieldDist[index] > 0)
+    {
+        for (int u = fieldParent[index]; u != fieldSource; u = fieldParent[u])
+        {
+            indexToTile[u]->setTileColor(sf::Color::Yellow);
+            hoverPath.push_back(indexToTile[u]);
+        }
+    }
+
+    auto stop = high_resolution_clock::now();
+    std::chrono::duration<double, std::milli> pathDuration = stop - start;
+    std::stringstream stream;
+    stream << std::fixed << std::setprecision(2) << "Field: " << fieldDuration.count() << " ms, " << fieldReached << " tiles" << (fieldBuilt ? " (built now)" : "");
+    resultLines.assign(1, stream.str());
+    stream.str("");
+
+    if (fieldDist[index] == -1)
+        stream << "Hover: no path";
+
+    else
+        stream << std::fixed << std::setprecision(1) << "Hover: " << fieldDist[index] << " moves, read back in " << pathDuration.count() * 1000 << " us";
+
+    resultLines.push_back(stream.str());
+    needsRedraw = true;
+}
+
+void Board::clearHoverPath()
+{
+    /*
+    Returns the tiles of the hover path to their resting color and forgets the hovered tile.
+    */
+    for (Tile* t: hoverPath)
+        t->setTileColor(restingColor(t->index));
+
+    hoverPath.clear();
+
+    if (hoverIndex != -1)
+    {
+        resultLines.clear();
+        needsRedraw = true;
+    }
+
+    hoverIndex = -1;
+}
+
+void Board::clearDistanceField()
+{
+    /*
+    Drops the distance field, together with its hover path and heat map.  Runs whenever the source or an obstacle
+    changes, since either makes the field out of date.
+    */
+    clearHoverPath();
+    fieldSource = -1;
+
+    if (heatPainted)
+        paintHeatMap();
+}
+
+bool Board::canAnimate(GraphType type)
+{
+    /*
+    Returns true if Go animates the engine's search.  The one-way map, linked list and flat engines all run the same
+    breadth first search, looking at neighbors in increasing index order, so the animation, which searches the CSR
+    arrays, expands the same tiles in the same order and finds the same path as any of them.
+    */
+    return !bidirectional && (type == GraphType::Map || type == GraphType::LinkedList || type == GraphType::Flat);
+}
+
+void Board::startAnimation()
+{
+    /*
+    Starts an animated search from the source, in the search workspace.  Nothing is expanded yet: the play loop
+    calls stepAnimation once per frame until the search is finished or cancelled.
+    */
+    beginSearch();
+    animation = AnimatedSearch();
+    animation.active = true;
+    animation.started = high_resolution_clock::now();
+    workVisited[source->index] = workEpoch;
+    workQueue[animation.tail++] = source->index;
+    animation.peak = 1;
+}
+
+void Board::stepAnimation()
+{
+    /*
+    Expands the animated search by up to animationTilesPerFrame tiles, stopping early once animationBudgetMs has
+    passed, so a frame is never held up for long.  Only the search itself is timed.  Afterwards the tiles expanded in
+    this slice are colored blue and the tiles it queued cyan, so the frontier can be seen moving out from the source.
+    The search is finished when the destination is reached or the queue runs dry.
+    */
+    auto start = high_resolution_clock::now();
+    int* q = workQueue.data();
+    int* p = workParent.data();
+    uint32_t* visited = workVisited.data();
+    uint32_t epoch = workEpoch;
+    const int* offsets = csrOffsets.data();
+    const int* targets = csrTargets.data();
+    const char* obst = obstacleMask.data();
+    int dest = destin->index;
+    int head = animation.head;
+    int tail = animation.tail;
+    int firstExpanded = head;
+    int firstQueued = tail;
+    long long edges = 0;
+
+    for (int count = 0; head < tail && !animation.endFound && count < animationTilesPerFrame; count++)
+    {
+        // The clock is only read every 32 tiles, since reading it costs about as much as expanding a tile.
+        if (count % 32 == 31 && high_resolution_clock::now() - start > std::chrono::duration<double, std::milli>(animationBudgetMs))
+            break;
+
+        int u = q[head++];
+
+        for (int e = offsets[u]; e < offsets[u + 1]; e++)
+        {
+            int v = targets[e];
+            edges++;
+
+            if (visited[v] != epoch && !obst[v])
+            {
+                visited[v] = epoch;
+                p[v] = u;
+
+                if (v == dest)
+                {
+                    animation.endFound = true;
+                    break;
+                }
+
+                q[tail++] = v;
+            }
+        }
+
+        animation.peak = std::max(animation.peak, tail - head);
+    }
+
+    animation.compute += high_resolution_clock::now() - start;
+    animation.head = head;
+    animation.tail = tail;
+    animation.edges += edges;
+
+    // Tiles queued and expanded within this slice end up blue.
+    for (int k = firstExpanded; k < head; k++)
+    {
+        if (q[k] != source->index)
+            indexToTile[q[k]]->setTileColor(sf::Color(40, 40, 160));
+    }
+
+    for (int k = std::max(firstQueued, head); k < tail; k++)
+        indexToTile[q[k]]->setTileColor(sf::Color::Cyan);
+
+    if (animation.endFound || head == tail)
+        finishAnimation();
+}
+
+void Board::finishAnimation()
+{
+    /*
+    Ends the animated search once it has its answer.  The tiles it colored go back to their resting color, the path
+    is shown, and resultLines get the time spent searching next to the time the animation was on screen, followed by
+    the query statistics.
+    */
+    double onScreen = std::chrono::duration<double, std::milli>(high_resolution_clock::now() - animation.started).count();
+    int* p = workParent.data();
+
+    if (!animation.endFound)
+        p[destin->index] = -1;
+
+    clearAnimation();
+    duration = animation.compute;
+    nodesExpanded = animation.head;
+    queryStats = QueryStats();
+    queryStats.searchMs = duration.count();
+    queryStats.dequeued = nodesExpanded;
+    queryStats.edgesScanned = animation.edges;
+    queryStats.peakQueue = animation.peak;
+
+    std::stringstream stream;
+    stream << std::fixed << std::setprecision(2) << "Animated: " << duration.count() << " ms searching, " << onScreen << " ms on screen";
+    resultLines.assign(1, stream.str());
+    displayShortestPath(p);
+    showQueryStats();
+}
+
+void Board::clearAnimation()
+{
+    /*
+    Stops the animated search and returns every tile it expanded or queued to its resting color.
+    */
+    animation.active = false;
+
+    for (int k = 0; k < animation.tail; k++)
+    {
+        Tile* t = indexToTile[workQueue[k]];
+
+        if (t != source && t != destin)
+            t->setTileColor(restingColor(t->index));
+    }
+}
+
+void Board::cancelAnimation()
+{
+    /*
+    Stops the animated search without a result.  The Go button can be pressed again.
+    */
+    clearAnimation();
+    goButtonClicked = false;
+    tryAgainClicked = false;
+    resultLines.clear();
+}
+
+int* Board::shortestPathParallel()
+{
+    /*
+    Level-synchronous BFS on the CSR arrays, spread across numThreads threads (the calling thread is one of them).
+    Each level's frontier is cut into chunks of tiles, and each thread starts with an equal, contiguous share of the
+    chunks.  A thread that runs out of chunks steals from the other threads' shares, so levels that are ragged
+    because of obstacles still keep every thread busy.  A tile is claimed by atomically swapping its workVisited stamp
+    to the current workEpoch, so each tile is added to exactly one thread's local next level, and only that thread
+    writes its parent into workParent.  At the end of a level the local next levels are appended to the shared one
+    and the threads wait at a barrier.
+    The other threads are a pool kept by the board: they are started by the first search and then sleep between
+    searches, so a search only wakes them rather than creating them.
+    */
+    auto start = high_resolution_clock::now();
+
+    const int chunkSize = 64;
+    int numVertices = indexToTile.size();
+    int numWorkers = std::max(1, numThreads);
+
+    if (parWorkers.size() != numWorkers - 1)
+    {
+        stopWorkers();
+        startWorkers(numWorkers - 1);
+    }
+
+    // Tiles are claimed through workVisited and their parents written to workParent, so nothing is allocated or
+    // filled per search.
+    beginSearch();
+    int* p = workParent.data();
+    uint32_t* visited = workVisited.data();
+    uint32_t epoch = workEpoch;
+    int src = source->index;
+    int dest = destin->index;
+    const int* offsets = csrOffsets.data();
+    const int* targets = csrTargets.data();
+    const char* obst = obstacleMask.data();
+
+    // The current level and the next level, swapped by thread 0 between levels.
+    parLevels[0].resize(numVertices);
+    parLevels[1].resize(numVertices);
+    parLocal.resize(numWorkers);
+    int* current = parLevels[0].data();
+    int* next = parLevels[1].data();
+    int currentSize = 1;
+    current[0] = src;
+    visited[src] = epoch;
+
+    std::atomic<int> nextSize(0);
+    std::atomic<bool> endFound(false);
+    std::atomic<long long> expanded(0);
+    bool done = false;
+
+    // Chunks of the current level owned by each thread: cursor[w] is the next chunk to take, chunkEnd[w] the end.
+    if (parChunkEnd.size() != numWorkers)
+    {
+        parCursor.reset(new std::atomic<int>[numWorkers]);
+        parChunkEnd.resize(numWorkers);
+    }
+
+    std::atomic<int>* cursor = parCursor.get();
+    int* chunkEnd = parChunkEnd.data();
+    SpinBarrier barrier(numWorkers);
+
+    // Hand out the chunks of the current level evenly.
+    auto splitLevel = [&]()
+    {
+        int numChunks = (currentSize + chunkSize - 1) / chunkSize;
+
+        for (int w = 0; w < numWorkers; w++)
+        {
+            cursor[w].store((long long)numChunks * w / numWorkers);
+            chunkEnd[w] = (long long)numChunks * (w + 1) / numWorkers;
+        }
+    };
+
+    auto work = [&](int w)
+    {
+        vector<int>& local = parLocal[w]; // This thread's part of the next level.
+        long long myExpanded = 0;
+        local.clear();
+
+        while (true)
+        {
+            // Take chunks from this thread's share first, then from the other threads' shares.
+            for (int k = 0; k < numWorkers && !endFound.load(std::memory_order_relaxed); k++)
+            {
+                int victim = (w + k) % numWorkers;
+
+                while (!endFound.load(std::memory_order_relaxed))
+                {
+                    int chunk = cursor[victim].fetch_add(1);
+
+                    if (chunk >= chunkEnd[victim])
+                        break;
+
+                    int last = std::min((chunk + 1) * chunkSize, currentSize);
+
+                    for (int x = chunk * chunkSize; x < last; x++)
+                    {
+                        int u = current[x];
+                        myExpanded++;
+
+                        for (int e = offsets[u]; e < offsets[u + 1]; e++)
+                        {
+                            int v = targets[e];
+
+                            if (obst[v])
+                                continue;
+
+                            // Other threads may be claiming v at the same time, so its stamp is only read atomically.
+                            uint32_t stamp = __atomic_load_n(&visited[v], __ATOMIC_RELAXED);
+
+                            if (stamp != epoch && __sync_bool_compare_and_swap(&visited[v], stamp, epoch))
+                            {
+                                p[v] = u;
+                                local.push_back(v);
+
+                                if (v == dest)
+                                    endFound.store(true);
+                            }
+                        }
+                    }
+                }
+            }
+
+            int at = nextSize.fetch_add(local.size());
+            std::copy(local.begin(), local.end(), next + at);
+            local.clear();
+            barrier.wait();
+
+            if (w == 0)
+            {
+                done = endFound.load() || nextSize.load() == 0;
+                std::swap(current, next);
+                currentSize = nextSize.load();
+                nextSize.store(0);
+                splitLevel();
+            }
+
+            barrier.wait();
+
+            if (done)
+                break;
+        }
+
+        expanded.fetch_add(myExpanded);
+    };
+
+    splitLevel();
+
+    // Hand the search to the pool and take part as thread 0.  The work refers to this function's locals, so it
+    // does not return until every worker is done with them.
+    parWork = work;
+    parRunning.store(numWorkers - 1);
+
+    {
+        std::lock_guard<std::mutex> lock(parMutex);
+        parJob++;
+    }
+
+    parWake.notify_all();
+    work(0);
+
+    while (parRunning.load() != 0)
+        std::this_thread::yield();
+
+    p[src] = -1;
+
+    if (!endFound.load())
+        p[dest] = -1;
+
+    nodesExpanded = expanded.load();
+
+    auto stop = high_resolution_clock::now();
+    duration = stop - start;
+
+    return p;
+}
+
+void Board::startWorkers(int count)
+{
+    /*
+    Starts the parallel engine's pool of count worker threads.  They sleep until shortestPathParallel hands them a
+    search.
+    */
+    long long job;
+
+    {
+        std::lock_guard<std::mutex> lock(parMutex);
+        parQuit = false;
+        job = parJob;
+    }
+
+    for (int w = 1; w <= count; w++)
+        parWorkers.emplace_back(&Board::workerLoop, this, w, job);
+}
+
+void Board::stopWorkers()
+{
+    /*
+    Wakes the parallel engine's worker threads to exit, and joins them.
+    */
+    {
+        std::lock_guard<std::mutex> lock(parMutex);
+        parQuit = true;
+    }
+
+    parWake.notify_all();
+
+    for (std::thread& t: parWorkers)
+        t.join();
+
+    parWorkers.clear();
+}
+
+void Board::workerLoop(int w, long long job)
+{
+    /*
+    Body of the parallel engine's worker thread w.  Sleeps until a search after job is handed out, runs its part of
+    it, and goes back to sleep, until stopWorkers tells it to exit.
+    */
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> lock(parMutex);
+            parWake.wait(lock, [&]() { return parQuit || parJob != job; });
+
+            if (parQuit)
+                return;
+
+            job = parJob;
+        }
+
+        parWork(w);
+        parRunning.fetch_sub(1);
+    }
+}
+
+template <typename Neighbors>
+int* Board::bidirectionalSearch(int src, int dest, Neighbors neighbors)
+{
+    /*
+    Breadth first search grown from both the source and the destination.  One whole level is expanded at a time,
+    always on the side whose frontier is smaller.  The first edge found between a tile of one side and a tile of the
+    other side joins a shortest path: every tile the other side has reached next to this level is in its current
+    frontier, since anything it expanded earlier would have claimed this level's tiles first.
+    The two parent chains are stitched into p so that it reads the same as the one-way engines' result.
+    The parents towards the source are the search workspace's workParent, and the reached marks are its epoch stamps,
+    so that, with the other arrays and the frontiers kept by the board, a search allocates nothing.
+    */
+    int numVertices = indexToTile.size();
+
+    if (biSide.size() != numVertices)
+    {
+        biParentBack.assign(numVertices, -1);
+        biSide.assign(numVertices, 0);
+    }
+
+    beginSearch();
+    int* p = workParent.data(); // Parents towards the source.
+    int* pBack = biParentBack.data(); // Parents towards the destination.
+    char* side = biSide.data(); // 1 if reached from the source, 2 if reached from the destination.  Only read where workVisited is current.
+    uint32_t* visited = workVisited.data();
+    uint32_t epoch = workEpoch;
+    vector<int>* frontier = biFrontier; // frontier[1] grows from the source, frontier[2] from the destination, frontier[0] is the next level.
+    vector<int>& next = frontier[0];
+    int adj[8];
+    int meetFrom = -1; // Tile of the expanding side on the joining edge.
+    int meetTo = -1; // Tile of the other side on the joining edge.
+    int meetSide = 0; // Side that was expanding when the two sides met.
+    nodesExpanded = 0;
+
+    for (int s = 0; s < 3; s++)
+        frontier[s].clear();
+
+    visited[src] = epoch;
+    visited[dest] = epoch;
+    side[src] = 1;
+    side[dest] = 2;
+    frontier[1].push_back(src);
+    frontier[2].push_back(dest);
+
+    while (meetSide == 0 && !frontier[1].empty() && !frontier[2].empty())
+    {
+        int s = frontier[1].size() <= frontier[2].size() ? 1 : 2;
+        int other = 3 - s;
+        int* parent = s == 1 ? p : pBack;
+        next.clear();
+
+        for (int u: frontier[s])
+        {
+            nodesExpanded++;
+            int count = neighbors(u, adj);
+
+            for (int k = 0; k < count; k++)
+            {
+                int v = adj[k];
+
+                if (visited[v] == epoch && side[v] == other)
+                {
+                    meetFrom = u;
+                    meetTo = v;
+                    meetSide = s;
+                    break;
+                }
+
+                if (visited[v] != epoch)
+                {
+                    visited[v] = epoch;
+                    side[v] = s;
+                    parent[v] = u;
+                    next.push_back(v);
+                }
+            }
+
+            if (meetSide != 0)
+                break;
+        }
+
+        frontier[s].swap(next);
+    }
+
+    if (meetSide == 0)
+        p[dest] = -1;
+
+    else
+    {
+        // Orient the joining edge from the source side to the destination side, then follow the destination side's
+        // parents and record each step in p.
+        int a = meetSide == 1 ? meetFrom : meetTo;
+        int b = meetSide == 1 ? meetTo : meetFrom;
+        p[b] = a;
+
+        while (b != dest)
+        {
+            p[pBack[b]] = b;
+            b = pBack[b];
+        }
+    }
+
+    return p;
+}
+
+int* Board::shortestPathGraphBidirectional()
+{
+    /*
+    Bidirectional version of shortestPathGraph.  Neighbors are found the same way, through posToTile and graphMap.
+    */
+    auto start = high_resolution_clock::now();
+
+    int* p = bidirectionalSearch(source->index, destin->index, [this](int u, int* out)
+    {
+        int count = 0;
+
+        for (Tile* n: graphMap[posToTile[{u / tilesX, u % tilesX}].first])
+        {
+            if (!obstacleMask[n->index])
+                out[count++] = n->index;
+        }
+
+        return count;
+    });
+
+    auto stop = high_resolution_clock::now();
+    duration = stop - start;
+
+    return p;
+}
+
+int* Board::shortestPathLLBidirectional()
+{
+    /*
+    Bidirectional version of shortestPathLL.  The source and destination nodes are still found by traversing the
+    linked list, and neighbors are found by following each node's pointers.
+    */
+    auto start = high_resolution_clock::now();
+    Node* src = traverseLL(source->index);
+    Node* dest = traverseLL(destin->index);
+    queryStats.seekMs = std::chrono::duration<double, std::milli>(high_resolution_clock::now() - start).count();
+
+    int* p = bidirectionalSearch(src->index, dest->index, [this](int u, int* out)
+    {
+        Node* current = posToTile[{u / tilesX, u % tilesX}].second;
+        Node* adj[8] = {current->botLeft, current->down, current->botRight, current->left, current->right, current->topLeft, current->up, current->topRight};
+        int count = 0;
+
+        for (Node* n: adj)
+        {
+            if (n != nullptr && !obstacleMask[n->index])
+                out[count++] = n->index;
+        }
+
+        return count;
+    });
+
+    auto stop = high_resolution_clock::now();
+    duration = stop - start;
+
+    return p;
+}
+
+int* Board::shortestPathFlatBidirectional()
+{
+    /*
+    Bidirectional version of shortestPathFlat.  Neighbors come straight from the CSR arrays.
+    */
+    auto start = high_resolution_clock::now();
+    const int* offsets = csrOffsets.data();
+    const int* targets = csrTargets.data();
+    const char* obst = obstacleMask.data();
+
+    int* p = bidirectionalSearch(source->index, destin->index, [=](int u, int* out)
+    {
+        int count = 0;
+
+        for (int e = offsets[u]; e < offsets[u + 1]; e++)
+        {
+            if (!obst[targets[e]])
+                out[count++] = targets[e];
+        }
+
+        return count;
+    });
+
+    auto stop = high_resolution_clock::now();
+    duration = stop - start;
+
+    return p;
+}
+
+int* Board::shortestPathNodes(Node* start, Node* end)
+{
+    /*
+    Does the same as shortestPathGraph, but for the LL implementation.  The same comments apply as in that function,
+    but we will comment code that applies specifically to this function.
+    */
+    beginSearch();
+    int* q = workQueue.data();
+    int qHead = 0;
+    int qTail = 0;
+    uint32_t* visited = workVisited.data();
+    uint32_t epoch = workEpoch;
+    bool endFound = false;
+    long long edges = 0;
+    int peak = 1;
+    int* p = workParent.data();
+    int strt = start->index;
+    int dest = end->index;
+    visited[strt] = epoch;
+    nodesExpanded = 0;
+
+    q[qTail++] = strt;
+
+    while (qHead < qTail && !endFound)
+    {
+        int u = q[qHead++];
+        nodesExpanded++;
+
+        int i = u / tilesX;
+        int j = u % tilesX;
+        Node* current = posToTile[{i, j}].second;
+        // Nearest neighbor nodes of current node in the queue, in increasing index order, as the map implementation
+        // visits them.
+        Node* adj[8] = {current->topLeft, current->up, current->topRight, current->left, current->right, current->botLeft, current->down, current->botRight};
+
+        for (Node* n: adj)
+        {
+            // If one of the nearest neighbors is nonexistent, move onto the next nearest neighbor node.
+            // For example, if current node is at row 0, there will be no nearest neighbors above the node.
+            if (n == nullptr)
+                continue;
+
+            int v = n->index;
+            edges++;
+			
+            if (visited[v] != epoch && !obstacleMask[v])
+            {
+                visited[v] = epoch;
+				p[v] = u;
+				
+				if (v == dest)
+				{
+					endFound = true;
+					break;
+				}
+				
+                else
+                    q[qTail++] = v;
+            }
+        }
+
+        peak = std::max(peak, qTail - qHead);
+    }
+
+    queryStats.edgesScanned = edges;
+    queryStats.peakQueue = peak;
+
+    if (!endFound)
+        p[dest] = -1;
+
+    return p;
+}
+
+bool Board::hasBidirectional(GraphType type)
+{
+    /*
+    Returns true if the engine has a bidirectional version.
+    */
+    return type == GraphType::Map || type == GraphType::LinkedList || type == GraphType::Flat;
+}
+
+int* Board::runEngine(GraphType type, bool bidirectionalMode)
+{
+    /*
+    Runs the shortest path algorithm of the given graph implementation on the current source and destination.
+    If bidirectionalMode is true and the engine has a bidirectional version, that version runs instead.  Starts a new
+    queryStats record: the engine's own time is split into its seek and search phases, and the hardware counters
+    run around it.  The path length and reconstruction time are added by displayShortestPath.
+    */
+    queryStats = QueryStats();
+    perfStart();
+    int* p = dispatchEngine(type, bidirectionalMode);
+    perfStop();
+    queryStats.searchMs = duration.count() - queryStats.seekMs;
+    queryStats.dequeued = nodesExpanded;
+
+    return p;
+}
+
+void Board::perfStart()
+{
+    /*
+    Resets and starts the hardware counters.  They are opened on the first call, for this thread and for user space
+    only.  Any counter that cannot be opened (no perf_event_open, no permission, or no such event on this CPU) is
+    left out, and its count stays -1.
+    */
+#ifdef __linux__
+    if (!perfOpened)
+    {
+        const uint64_t events[4] = {PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES};
+        perfOpened = true;
+
+        for (int k = 0; k < 4; k++)
+        {
+            perf_event_attr attr;
+            memset(&attr, 0, sizeof(attr));
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.size = sizeof(attr);
+            attr.config = events[k];
+            attr.disabled = 1;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            perfFds[k] = syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+        }
+    }
+
+    for (int fd: perfFds)
+    {
+        if (fd >= 0)
+        {
+            ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+            ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+        }
+    }
+#endif
+}
+
+void Board::perfStop()
+{
+    /*
+    Stops the hardware counters and copies their counts into queryStats.  The parallel engine's worker threads are
+    not counted, only the calling thread.
+    */
+#ifdef __linux__
+    long long* counts[4] = {&queryStats.cycles, &queryStats.instructions, &queryStats.llcMisses, &queryStats.branchMisses};
+
+    for (int k = 0; k < 4; k++)
+    {
+        uint64_t count;
+
+        if (perfFds[k] >= 0)
+        {
+            ioctl(perfFds[k], PERF_EVENT_IOC_DISABLE, 0);
+
+            if (read(perfFds[k], &count, sizeof(count)) == sizeof(count))
+                *counts[k] = count;
+        }
+    }
+#endif
+}
+
+void Board::showQueryStats()
+{
+    /*
+    Appends the statistics of the last query to resultLines: where the time went, what the search did, and the
+    hardware counts when they are available.
+    */
+    const QueryStats& stats = queryStats;
+    std::stringstream times;
+    times << std::fixed << std::setprecision(2) << "Seek " << stats.seekMs << " / search " << stats.searchMs << " / path " << stats.reconstructMs << " ms";
+    resultLines.push_back(times.str());
+
+    if (stats.cached)
+        resultLines.push_back("Path from cache, no search");
+
+    else
+    {
+        string line = "Dequeued " + std::to_string(stats.dequeued);
+
+        if (stats.edgesScanned != -1)
+            line += ", edges " + std::to_string(stats.edgesScanned);
+
+        if (stats.peakQueue != -1)
+            line += ", peak queue " + std::to_string(stats.peakQueue);
+
+        resultLines.push_back(line);
+    }
+
+    if (stats.cycles != -1 && stats.instructions != -1)
+    {
+        std::stringstream counters;
+        counters << std::fixed << std::setprecision(2) << "IPC " << double(stats.instructions) / std::max(stats.cycles, 1LL);
+
+        if (stats.llcMisses != -1)
+            counters << ", LLC misses " << stats.llcMisses;
+
+        if (stats.branchMisses != -1)
+            counters << ", branch misses " << stats.branchMisses;
+
+        resultLines.push_back(counters.str());
+    }
+}
+
+int* Board::dispatchEngine(GraphType type, bool bidirectionalMode)
+{
+    /*
+    Calls the shortest path function of the given graph implementation, or its bidirectional version if
+    bidirectionalMode is true and it has one.
+    */
+    if (bidirectionalMode && hasBidirectional(type))
+    {
+        if (type == GraphType::Map)
+            return shortestPathGraphBidirectional();
+
+        else if (type == GraphType::LinkedList)
+            return shortestPathLLBidirectional();
+
+        else
+            return shortestPathFlatBidirectional();
+    }
+
+    switch (type)
+    {
+        case GraphType::LinkedList:
+            return shortestPathLL();
+        case GraphType::Map:
+            return shortestPathGraph();
+        case GraphType::Flat:
+            return shortestPathFlat();
+        case GraphType::Bitboard:
+            return shortestPathBits();
+        case GraphType::DirectionOptimizing:
+            return shortestPathDirOpt();
+        case GraphType::Parallel:
+            return shortestPathParallel();
+        case GraphType::Incremental:
+            return shortestPathIncremental();
+        case GraphType::DistanceField:
+            return shortestPathField();
+        case GraphType::JumpPoint:
+            return shortestPathJPS();
+        case GraphType::AStar:
+            return shortestPathAStar();
+        case GraphType::Hierarchical:
+            return shortestPathHPA();
+        case GraphType::Specialized:
+            return shortestPathSpecialized();
+        case GraphType::RuntimeGrid:
+            return shortestPathRuntimeGrid();
+        case GraphType::Weighted:
+            return shortestPathWeighted();
+        default:
+            return nullptr;
+    }
+}
+
+int* Board::runSelectedEngine()
+{
+    /*
+    Runs the selected engine for the Go button and fills resultLines with the comparisons and statistics that
+    belong to it.
+    */
+
+    // In bidirectional mode, time the one-way search first so that the two can be compared.
+    if (bidirectional && hasBidirectional(graphType))
+    {
+        releasePath(runEngine(graphType, false));
+        std::stringstream stream;
+        stream << std::fixed << std::setprecision(2) << "One-way: " << duration.count() << " ms, " << nodesExpanded << " tiles";
+        resultLines.push_back(stream.str());
+    }
+
+    // Run the algorithm of the selected graph implementation.
+    int* p = runEngine(graphType, bidirectional);
+
+    if (bidirectional && hasBidirectional(graphType))
+    {
+        std::stringstream stream;
+        stream << std::fixed << std::setprecision(2) << "Bidirectional: " << duration.count() << " ms, " << nodesExpanded << " tiles";
+        resultLines.push_back(stream.str());
+    }
+
+    // The expanded-node count is shown by showQueryStats.  Jump point search expands jump points only, so the tiles
+    // its jumps stepped over are shown as well.
+    else if (graphType == GraphType::JumpPoint)
+        resultLines.push_back("Tiles scanned: " + std::to_string(jpsScanned));
+
+    // The hierarchical engine's count includes the clusters it had to rebuild first.
+    else if (graphType == GraphType::Hierarchical)
+        resultLines.push_back("Clusters rebuilt: " + std::to_string(hpaRebuilt));
+
+    // The weighted engine's path is the cheapest, not the shortest, so its cost is shown with the search it used.
+    else if (graphType == GraphType::Weighted)
+        resultLines.push_back("Path cost: " + std::to_string(pathCost) + (heavyTiles == 0 ? " (0-1 BFS)" : " (Dial)"));
+
+    // Summarize how the direction-optimizing engine split its levels.
+    if (graphType == GraphType::DirectionOptimizing)
+    {
+        int bottomUpLevels = 0;
+        long long edgesChecked = 0;
+
+        for (const LevelStats& stats: levelStats)
+        {
+            bottomUpLevels += stats.bottomUp;
+            edgesChecked += stats.edgesChecked;
+        }
+
+        resultLines.push_back("Levels: " + std::to_string(levelStats.size() - bottomUpLevels) + " top-down, " + std::to_string(bottomUpLevels) + " bottom-up");
+        resultLines.push_back("Edges checked: " + std::to_string(edgesChecked));
+    }
+
+    return p;
+}
+
+Board::CacheKey Board::cacheKey(GraphType type, bool bidirectionalMode)
+{
+    /*
+    Returns the path cache key of the current query.  The moves are gridConnectivity for the grid engines, which
+    can be limited to orthogonal moves, and 8 for every other engine.  Only the weighted engine reads the terrain,
+    so only its key has the terrain hash in it, and painting terrain leaves the other engines' paths cached.
+    */
+    int moves = type == GraphType::Specialized || type == GraphType::RuntimeGrid ? gridConnectivity : 8;
+    uint64_t terrain = type == GraphType::Weighted ? terrainHash : 0;
+    return CacheKey(source->index, destin->index, (int)type, bidirectionalMode && hasBidirectional(type), moves, obstacleHash, terrain);
+}
+
+int* Board::cachedPath(GraphType type, bool bidirectionalMode)
+{
+    /*
+    Looks up the current query in the path cache.  On a hit the entry becomes the most recently used, and a p array
+    holding just the cached path is returned, so only the path's entries are written.  Returns nullptr on a miss.
+    Both cases are counted in cacheHits and cacheMisses.
+    */
+    if (!cacheEnabled)
+        return nullptr;
+
+    auto start = high_resolution_clock::now();
+    CacheKey key = cacheKey(type, bidirectionalMode);
+    auto found = cacheIndex.find(key);
+
+    if (found == cacheIndex.end())
+    {
+        cacheMisses++;
+        return nullptr;
+    }
+
+    cacheHits++;
+    queryStats = QueryStats();
+    queryStats.cached = true;
+    cacheEntries.splice(cacheEntries.begin(), cacheEntries, found->second);
+    const vector<int>& path = found->second->second;
+
+    // The path is written into the search workspace, so a hit allocates nothing.
+    beginSearch();
+    int* p = workParent.data();
+
+    // The cached path runs from the destination back to the source, so each tile's parent is the one after it.
+    if (path.empty())
+        p[destin->index] = -1;
+
+    for (int k = 0; k + 1 < path.size(); k++)
+        p[path[k]] = path[k + 1];
+
+    nodesExpanded = 0;
+    auto stop = high_resolution_clock::now();
+    duration = stop - start;
+    queryStats.searchMs = duration.count();
+
+    return p;
+}
+
+void Board::cachePath(GraphType type, bool bidirectionalMode, const int* p)
+{
+    /*
+    Stores the path in p for the current query, evicting the least recently used entry when the cache is full.
+    */
+    if (!cacheEnabled || cacheCapacity <= 0)
+        return;
+
+    CacheKey key = cacheKey(type, bidirectionalMode);
+    vector<int> path;
+
+    if (p[destin->index] != -1)
+    {
+        for (int u = destin->index; u != source->index; u = p[u])
+            path.push_back(u);
+
+        path.push_back(source->index);
+    }
+
+    if (cacheIndex.count(key))
+    {
+        cacheEntries.erase(cacheIndex[key]);
+        cacheIndex.erase(key);
+    }
+
+    while (cacheEntries.size() >= cacheCapacity)
+    {
+        cacheIndex.erase(cacheEntries.back().first);
+        cacheEntries.pop_back();
+    }
+
+    cacheEntries.push_front({key, path});
+    cacheIndex[key] = cacheEntries.begin();
+}
+
+void Board::displayShortestPath(int* p)
+{
+    /*
+    This function will take the p array and push the tiles making up the shortest path to vector shortestPath.
+    Each tile (except source and destination tiles) will have its color changed to yellow.  If no path exists,
+    push nullptr to shortestPath and exit the function.  The time taken and the path length go to queryStats.
+    */
+    auto start = high_resolution_clock::now();
+
+    if (p[destin->index] == -1)
+        shortestPath.push_back(nullptr);
+
+    else
+    {
+        shortestPath.push_back(source);
+        int prev = p[destin->index];
+	
+	    while (prev != source->index)
+	    {
+		    int i = prev / tilesX;
+            int j = prev % tilesX;
+            posToTile[{i, j}].first->setTileColor(sf::Color::Yellow);
+            shortestPath.push_back(posToTile[{i, j}].first);
+		    prev = p[prev];
+	    }
+    }
+
+    releasePath(p);
+    queryStats.pathLength = shortestPath[0] == nullptr ? -1 : shortestPath.size();
+    queryStats.reconstructMs = std::chrono::duration<double, std::milli>(high_resolution_clock::now() - start).count();
+}
+
+void Board::clearShortestPath()
+{
+    /*
+    If a path was found during the most recent run, make the path tiles (except for the source and destination
+    tiles) return to their default color (Black).  Then clear the shortestPath vector whether or not a path was found.
+    */
+    if (shortestPath.size() > 0 && shortestPath[0] != nullptr)
+    {
+        for (int i = 0; i < shortestPath.size(); i++)
+        {
+            if (shortestPath[i] != source && shortestPath[i] != destin)
+                shortestPath[i]->setTileColor(restingColor(shortestPath[i]->index));
+        }
+    }
+
+    shortestPath.clear();
+}
+
+void Board::resetBoard()
+{
+    /*
+    This function runs when user selects to reset board button.  Board is reset so that all tiles are black and
+    all selections are undone.  It allows the user to start over.
+    */
+
+    // Drop an animated search and the distance field first, so that their tiles are returned to black.
+    if (animation.active)
+        clearAnimation();
+
+    clearDistanceField();
+
+    // Reset source tile selection.
+    if (source != nullptr)
+    {
+        source->setTileColor(sf::Color::Black);
+        source = nullptr;
+    }
+
+    // Reset destination tile selection.
+    if (destin != nullptr)
+    {
+        destin->setTileColor(sf::Color::Black);
+        destin = nullptr;
+    }
+
+    // Reset member variables to their default values.
+    graphType = GraphType::None;
+    bidirectional = false;
+    resultLines.clear();
+    goButtonClicked = false;
+    tryAgainClicked = false;
+    source = nullptr;
+    destin = nullptr;
+
+    // Remove every obstacle and return every tile to plain ground.  Both go through the layout setters, so that
+    // everything setObstacle and setTerrain keep in sync is reset with them.  They also return the tiles of a
+    // previously found shortest path to black.
+    setObstacleLayout(vector<char>(numTiles(), 0));
+    setTerrainLayout(vector<unsigned char>(numTiles(), 1));
+    incDest = -1;
+}
+
+/*==== Public Functions ====*/
+
+Board::Board(const string& snapshotPath)
+{
+    /*
+    Board constructor.  Sets member variables to default values.  The graphs are loaded from snapshotPath if it holds
+    a valid snapshot.  Otherwise they are built, and, if a path was given, a snapshot is written there for next time.
+    */
+    head = nullptr;
+    needsRedraw = true;
+    source = nullptr;
+    destin = nullptr;
+    graphType = GraphType::None;
+    goButtonClicked = false;
+    tryAgainClicked = false;
+    nodesExpanded = 0;
+    bidirectional = false;
+    dirAlpha = 14;
+    dirBeta = 24;
+    numThreads = std::max(1, (int)std::thread::hardware_concurrency());
+    gridConnectivity = 8;
+    gridEpoch = 0;
+    parJob = 0;
+    parQuit = false;
+    parRunning.store(0);
+    incSource = -1;
+    incDest = -1;
+    jpsScanned = 0;
+    hpaRebuilt = 0;
+    fieldSource = -1;
+    hoverIndex = -1;
+    heatMap = false;
+    animate = false;
+    terrainBrush = -1;
+    pathCost = -1;
+    heatPainted = false;
+    cacheCapacity = 256;
+    cacheEnabled = true;
+    cacheHits = 0;
+    cacheMisses = 0;
+    obstacleHash = 0;
+    terrainHash = 0;
+    workEpoch = 0;
+    perfOpened = false;
+    std::fill(perfFds, perfFds + 4, -1);
+    engineText[GraphType::Flat] = sf::Text();
+    engineText[GraphType::Bitboard] = sf::Text();
+    engineText[GraphType::DirectionOptimizing] = sf::Text();
+    engineText[GraphType::Parallel] = sf::Text();
+    engineText[GraphType::Incremental] = sf::Text();
+    engineText[GraphType::DistanceField] = sf::Text();
+    engineText[GraphType::JumpPoint] = sf::Text();
+    engineText[GraphType::AStar] = sf::Text();
+    engineText[GraphType::Hierarchical] = sf::Text();
+    engineText[GraphType::Specialized] = sf::Text();
+    engineText[GraphType::RuntimeGrid] = sf::Text();
+    engineText[GraphType::Weighted] = sf::Text();
+
+    auto start = high_resolution_clock::now();
+    snapshotLoaded = !snapshotPath.empty() && loadSnapshot(snapshotPath);
+
+    if (!snapshotLoaded)
+        makeGraphs();
+
+    setupDuration = high_resolution_clock::now() - start;
+
+    if (!snapshotLoaded && !snapshotPath.empty())
+        saveSnapshot(snapshotPath);
+}
+
+Board::~Board()
+{
+    /*
+    Destructor that will free up any remaining memory, clearing out the data structures.  Tiles and nodes are
+    freed with tilePool and nodePool, one block each, so they are not visited one by one.
+    */
+
+    // Join the parallel engine's worker threads.
+    stopWorkers();
+
+    // Clear member vectors/maps and graph data structures.  Set pointers to nullptr.
+    posToTile.clear();
+    graphMap.clear();
+    indexToTile.clear();
+    csrOffsets.clear();
+    csrTargets.clear();
+    obstacleMask.clear();
+    freeBits.clear();
+    shortestPath.clear();
+    obstacles.clear();
+    head = nullptr;
+    source = nullptr;
+    destin = nullptr;
+
+#ifdef __linux__
+    for (int fd: perfFds)
+    {
+        if (fd >= 0)
+            close(fd);
+    }
+#endif
+}
+
+void Board::play(sf::RenderWindow& window)
+{
+    /*
+    This function is the function that runs in main() and is responsible for displaying the window, board, text,
+    and is responsible for accepting user input and outputting results.
+    */
+    // An animated search redraws every frame, so frames are paced.
+    window.setFramerateLimit(60);
+
+    while (window.isOpen())
+    {
+        // Event object: events include mouse being pressed, keyboard press, etc.
+        sf::Event event;
+        // When there is nothing to redraw and no animated search running, sleep until the next event instead of
+        // spinning.  That event is handled first, then any others already waiting.
+        bool waited = !needsRedraw && !animation.active && window.waitEvent(event);
+
+        while (waited || window.pollEvent(event))
+        {
+            waited = false;
+
+            // Event recorded is one that is reponsible for closing the window.
+            if (event.type == sf::Event::Closed)
+                window.close();
+
+            // The window's contents may have been lost or scaled, so draw them again.
+            else if (event.type == sf::Event::Resized || event.type == sf::Event::GainedFocus || event.type == sf::Event::MouseEntered)
+                needsRedraw = true;
+
+            // Keys 0 to 9 pick the terrain cost painted by right-clicks.
+            else if (event.type == sf::Event::KeyPressed && event.key.code >= sf::Keyboard::Num0 && event.key.code <= sf::Keyboard::Num9)
+            {
+                terrainBrush = event.key.code - sf::Keyboard::Num0;
+                needsRedraw = true;
+            }
+
+            // Escape cancels an animated search.
+            else if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::Escape && animation.active)
+            {
+                cancelAnimation();
+                needsRedraw = true;
+            }
+
+            // Mouse moved.  With the distance field engine selected and only the source chosen, the path to the tile under
+            // the mouse is shown, read back from the source's distance field without searching.
+            else if (event.type == sf::Event::MouseMoved)
+            {
+                int i = event.mouseMove.y / (ySize + 1);
+                int j = event.mouseMove.x / (xSize + 1);
+
+                // Dragging past the left or top edge of the window gives negative coordinates, so both ends are checked.
+                // The tile is looked up by index, so a mouse move never adds an entry to posToTile.
+                if (graphType == GraphType::DistanceField && source != nullptr && destin == nullptr && !goButtonClicked && i >= 0 && j >= 0 && i < tilesY && j < tilesX && !obstacleMask[i * tilesX + j])
+                    showHoverPath(indexToTile[i * tilesX + j]->index);
+
+                else if (hoverIndex != -1)
+                    clearHoverPath();
+            }
+
+            // User pressed a mouse button.  Tile colors ask for a redraw themselves, but a click can also change the
+            // text and buttons, so always redraw after one.
+            else if (event.type == sf::Event::MouseButtonPressed)
+            {
+                needsRedraw = true;
+                // Record the position of the mouse when user pressed a mouse button.
+                sf::Vector2i position = sf::Mouse::getPosition(window);
+                // Find what tile the user clicked on (if any).
+                int i = position.y / (ySize + 1);
+                int j = position.x / (xSize + 1);
+
+                // User left-clicked on a tile.  The source and destination cannot change while an animated search runs.
+                if (event.mouseButton.button == sf::Mouse::Left && i < tilesY && j < tilesX && !animation.active)
+                {
+                    // Source tile has not been selected yet, so tile selected will be source tile,
+                    // as long as it wasn't selected to be an obstacle.
+                    if (source == nullptr && !obstacleMask[posToTile[{i, j}].first->index])
+                    {
+                        posToTile[{i, j}].first->setTileColor(sf::Color::Green);
+                        source = posToTile[{i, j}].first;
+                    }
+
+                    // Source tile was already selected and user clicked on that same tile: undo selection.
+                    else if (source == posToTile[{i, j}].first && destin == nullptr)
+                    {
+                        clearDistanceField();
+                        posToTile[{i, j}].first->setTileColor(restingColor(posToTile[{i, j}].first->index));
+                        source = nullptr;
+                    }
+
+                    // Source tile was already selected and user clicked on a different tile, setting it as the destination,
+                    // as long as it wasn't selected to be an obstacle.
+                    else if (source != posToTile[{i, j}].first && destin == nullptr && !obstacleMask[posToTile[{i, j}].first->index])
+                    {
+                        clearHoverPath();
+                        posToTile[{i, j}].first->setTileColor(sf::Color::Red);
+                        destin = posToTile[{i, j}].first;
+                    }
+
+                    // Destination tile was already selected and user clicked on that same tile: undo selection.
+                    else if (destin == posToTile[{i, j}].first)
+                    {
+                        posToTile[{i, j}].first->setTileColor(restingColor(posToTile[{i, j}].first->index));
+                        destin = nullptr;
+                    }
+                }
+
+                // User right-clicked on a tile with the terrain brush on and the Go button wasn't pressed.  The brush's cost
+                // is painted on any free tile other than the source and destination.
+                else if (event.mouseButton.button == sf::Mouse::Right && i < tilesY && j < tilesX && terrainBrush != -1)
+                {
+                    Tile* tile = posToTile[{i, j}].first;
+
+                    if (!goButtonClicked && tile != source && tile != destin && !obstacleMask[tile->index])
+                        setTerrain(tile, terrainBrush);
+                }
+
+                // User right-clicked on a tile and the Go button wasn't pressed.  With the incremental engine, obstacles
+                // can still be painted after Go, and the path is repaired after each one.
+                else if (event.mouseButton.button == sf::Mouse::Right && i < tilesY && j < tilesX && (!goButtonClicked || graphType == GraphType::Incremental))
+                {
+                    bool repairPath = goButtonClicked && graphType == GraphType::Incremental;
+
+                    // Return the old path to black before the obstacle is painted, in case the obstacle lies on it.
+                    if (repairPath)
+                        clearShortestPath();
+
+                    // User right-clicked on an empty tile (not source and not destination)
+                    // Set that tile as an obstacle tile, as long as there is room for a source and destination tile.
+                    if (source != posToTile[{i, j}].first && destin != posToTile[{i, j}].first && !obstacleMask[posToTile[{i, j}].first->index] && obstacles.size() < graphMap.size() - 2)
+                        setObstacle(posToTile[{i, j}].first, true);
+
+                    // Undo selection of an obstacle tile.
+                    else if (obstacleMask[posToTile[{i, j}].first->index])
+                        setObstacle(posToTile[{i, j}].first, false);
+
+                    if (repairPath)
+                    {
+                        displayShortestPath(runEngine(graphType, false));
+                        resultLines.assign(1, "Repair expanded " + std::to_string(nodesExpanded) + " tiles");
+                    }
+                }
+
+                // User left-clicked off the grid, where user-selections take place.
+                else if (event.mouseButton.button == sf::Mouse::Left && j > tilesY)
+                {
+                    // User clicked on the LL button before Go button was pressed, thereby choosing the LL implementation.
+                    if(linkedListSprite.getGlobalBounds().contains(position.x, position.y) && !goButtonClicked)
+                        graphType = GraphType::LinkedList;
+
+                    // User clicked on the map button before Go button was pressed, thereby choosing the map implementation.
+                    else if (mapSprite.getGlobalBounds().contains(position.x, position.y) && !goButtonClicked)
+                        graphType = GraphType::Map;
+
+                    // User clicked on the text button of one of the other engines before Go button was pressed.
+                    else if (!goButtonClicked && engineClicked(position) != GraphType::None)
+                        graphType = engineClicked(position);
+
+                    // User clicked on the bidirectional mode text before Go button was pressed.
+                    else if (bidirectionalText.getGlobalBounds().contains(position.x, position.y) && !goButtonClicked)
+                        bidirectional = !bidirectional;
+
+                    // User clicked on the animate text before Go button was pressed.
+                    else if (animateText.getGlobalBounds().contains(position.x, position.y) && !goButtonClicked)
+                        animate = !animate;
+
+                    // User clicked on the terrain brush text: step to the next cost, or from the highest back to off.
+                    else if (terrainText.getGlobalBounds().contains(position.x, position.y))
+                        terrainBrush = terrainBrush == maxTerrainCost ? -1 : terrainBrush + 1;
+
+                    // User clicked on the heat map text.  If there is a distance field, it is painted or unpainted now.
+                    else if (heatMapText.getGlobalBounds().contains(position.x, position.y))
+                    {
+                        heatMap = !heatMap;
+                        paintHeatMap();
+                    }
+
+                    // User clicked on reset board button.
+                    else if (resetSprite.getGlobalBounds().contains(position.x, position.y))
+                        resetBoard();
+
+                    // User clicked on Go button, so run the appropriate shortest path algorithm, depending on which graph implemented they selected.
+                    else if (goSprite.getGlobalBounds().contains(position.x, position.y) && shortestPath.size() == 0 && !animation.active)
+                    {
+                        goButtonClicked = true;
+                        tryAgainClicked = true;
+                        resultLines.clear();
+
+                        // With animate on, the search runs a slice per frame from the end of this loop instead.
+                        if (animate && canAnimate(graphType))
+                        {
+                            startAnimation();
+                            continue;
+                        }
+
+                        // A cache hit skips the search entirely.
+                        int* p = cachedPath(graphType, bidirectional);
+
+                        if (p == nullptr)
+                        {
+                            p = runSelectedEngine();
+                            cachePath(graphType, bidirectional, p);
+                        }
+
+                        resultLines.push_back("Cache: " + std::to_string(cacheHits) + " hits, " + std::to_string(cacheMisses) + " misses");
+
+                        // After algorithm finishes, display the shortest path if it exists, then where the time went.
+                        displayShortestPath(p);
+                        showQueryStats();
+                    }
+
+                    // User clicked Try Again button, so user can run the algorithm again using the same tile selections.
+                    // This allows the user to quickly compare graph implementations in terms of running time.
+                    else if (tryAgainSprite.getGlobalBounds().contains(position.x, position.y))
+                    {
+                        // An animated search still running is dropped.
+                        if (animation.active)
+                            clearAnimation();
+
+                        tryAgainClicked = false;
+                        goButtonClicked = false;
+                        graphType = GraphType::None;
+                        
+                        // Return the previous path to black so the next run starts from a clean board.
+                        clearShortestPath();
+                    }
+                }
+            }
+        }
+
+        // Advance the animated search by one frame's slice.
+        if (animation.active)
+            stepAnimation();
+
+        // After all updates have finished processing, display the updated state of the board if anything changed.
+        if (needsRedraw && window.isOpen())
+        {
+            window.clear();
+            displayBoard(window);
+            window.display();
+            needsRedraw = false;
+        }
+    }
+}
+
+int Board::numTiles()
+{
+    /*
+    Returns the number of tiles (vertices) on the board.
+    */
+    return indexToTile.size();
+}
+
+bool Board::setQuery(int src, int dest)
+{
+    /*
+    Selects the tiles at indices src and dest as the source and destination, replacing any previous selection.
+    This does the same as left-clicking the two tiles, without needing a window.
+    */
+    int numVertices = indexToTile.size();
+
+    if (src < 0 || src >= numVertices || dest < 0 || dest >= numVertices || src == dest || obstacleMask[src] || obstacleMask[dest])
+        return false;
+
+    clearShortestPath();
+
+    // The distance field is kept, since it is still right for any query from its source, but not its hover path.
+    clearHoverPath();
+
+    if (source != nullptr)
+    {
+        source->setTileColor(restingColor(source->index));
+    }
+
+    if (destin != nullptr)
+    {
+        destin->setTileColor(restingColor(destin->index));
+    }
+
+    source = indexToTile[src];
+    source->setTileColor(sf::Color::Green);
+    destin = indexToTile[dest];
+    destin->setTileColor(sf::Color::Red);
+
+    return true;
+}
+
+void Board::setObstacleAt(int index, bool isObstacle)
+{
+    /*
+    Marks or unmarks the tile at index as an obstacle, the same as right-clicking it.  The source and destination
+    tiles can never become obstacles.
+    */
+    if (index < 0 || index >= indexToTile.size() || indexToTile[index] == source || indexToTile[index] == destin || obstacleMask[index] == isObstacle)
+        return;
+
+    clearShortestPath();
+    setObstacle(indexToTile[index], isObstacle);
+}
+
+void Board::setObstacles(const vector<int>& indices)
+{
+    /*
+    Replaces the current obstacle layout with the tiles at the given indices.  This does the same as right-clicking
+    each tile, without needing a window.  The source and destination tiles can never become obstacles.
+    */
+    vector<char> blocked(indexToTile.size(), 0);
+
+    for (int u: indices)
+    {
+        if (u >= 0 && u < indexToTile.size())
+            blocked[u] = 1;
+    }
+
+    setObstacleLayout(blocked);
+}
+
+bool Board::obstacleAt(int index)
+{
+    /*
+    Returns true if the tile at index is an obstacle.
+    */
+    return index >= 0 && index < obstacleMask.size() && obstacleMask[index];
+}
+
+void Board::setTerrainAt(int index, int cost)
+{
+    /*
+    Sets the cost of entering the tile at index, the same as right-clicking it with the terrain brush.  The cost is
+    clamped to 0 to maxTerrainCost.
+    */
+    if (index < 0 || index >= indexToTile.size())
+        return;
+
+    clearShortestPath();
+    setTerrain(indexToTile[index], std::max(0, std::min(cost, maxTerrainCost)));
+}
+
+void Board::setTerrainLayout(const vector<unsigned char>& costs)
+{
+    /*
+    Replaces the terrain cost of every tile with costs, clamped to maxTerrainCost.
+    */
+    clearShortestPath();
+
+    for (int u = 0; u < indexToTile.size() && u < costs.size(); u++)
+        setTerrain(indexToTile[u], std::min<int>(costs[u], maxTerrainCost));
+}
+
+int Board::terrainAt(int index)
+{
+    /*
+    Returns the cost of entering the tile at index.
+    */
+    return terrainCost[index];
+}
+
+int Board::lastPathCost()
+{
+    /*
+    Returns the terrain cost of the path found by the most recent query, -1 if it found none.  It is added up from
+    the path's tiles, so it is also right for a path that came from the path cache.
+    */
+    if (shortestPath.empty() || shortestPath[0] == nullptr)
+        return -1;
+
+    // shortestPath holds the source and the tiles between it and the destination.
+    int cost = terrainCost[destin->index];
+
+    for (int k = 1; k < shortestPath.size(); k++)
+        cost += terrainCost[shortestPath[k]->index];
+
+    return cost;
+}
+
+bool Board::flatTerrain()
+{
+    /*
+    Returns true if every tile costs 1 to enter, as on a board with no terrain painted or loaded.
+    */
+    return terrainTiles == 0;
+}
+
+bool Board::loadObstacleMap(const string& path)
+{
+    /*
+    Loads an obstacle layout from a MovingAI .map file or from a binary layout file written by saveObstacleMap,
+    which starts with an ObstacleMapHeader and is mapped into memory rather than read.  The layout is laid on the
+    board from the top left corner: any part of it beyond the board is cut off, and board tiles beyond it become
+    obstacles.  It replaces the current layout and terrain in one pass.  If a binary layout has a source and
+    destination on the board, they are selected too.  Returns false, leaving the board unchanged, if the file cannot
+    be read or is in neither format.
+    */
+    vector<char> blocked(indexToTile.size(), 1);
+    vector<unsigned char> costs(indexToTile.size(), 1);
+    int src = -1;
+    int dest = -1;
+    size_t size = 0;
+    const char* data = mapFile(path, size);
+
+    if (data == nullptr)
+        return false;
+
+    ObstacleMapHeader header;
+    bool binary = size >= sizeof(header) && memcmp(data, "BFSO", 4) == 0;
+
+    if (binary)
+    {
+        memcpy(&header, data, sizeof(header));
+        uint64_t rowBytes = (uint64_t(header.width) + 7) / 8;
+        // Version 1 files end after the obstacle bits.  Version 2 adds a terrain cost byte per tile.
+        uint64_t terrainBytes = header.version >= 2 ? uint64_t(header.width) * header.height : 0;
+        bool valid = header.version >= 1 && header.version <= obstacleMapVersion && header.width > 0 && header.height > 0
+            && size == sizeof(header) + rowBytes * header.height + terrainBytes;
+        const unsigned char* terrain = (const unsigned char*)data + sizeof(header) + rowBytes * header.height;
+
+        for (int i = 0; valid && i < std::min<uint32_t>(header.height, tilesY); i++)
+        {
+            const unsigned char* row = (const unsigned char*)data + sizeof(header) + i * rowBytes;
+
+            for (int j = 0; j < std::min<uint32_t>(header.width, tilesX); j++)
+            {
+                blocked[i * tilesX + j] = (row[j / 8] >> (j % 8)) & 1;
+
+                if (terrainBytes > 0)
+                    costs[i * tilesX + j] = std::min<int>(terrain[uint64_t(i) * header.width + j], maxTerrainCost);
+            }
+        }
+
+        // The source and destination are stored as indices into the layout, not the board.
+        if (valid && header.source >= 0 && header.source % header.width < tilesX && header.source / header.width < tilesY)
+            src = header.source / header.width * tilesX + header.source % header.width;
+
+        if (valid && header.destination >= 0 && header.destination % header.width < tilesX && header.destination / header.width < tilesY)
+            dest = header.destination / header.width * tilesX + header.destination % header.width;
+
+        unmapFile(data, size);
+
+        if (!valid)
+            return false;
+    }
+
+    else
+    {
+        unmapFile(data, size);
+
+        // MovingAI format: "type", "height" and "width" lines, then "map", then one line of characters per row.
+        // '.', 'G' and 'S' are passable; '@', 'O', 'T' and 'W' are not.  Swamp ('S') costs swampCost to enter, and
+        // the digits '0' to '9', which saveObstacleMap writes for other costs, are passable tiles of that cost.
+        std::ifstream in(path);
+        string word;
+        int width = -1;
+        int height = -1;
+
+        while (in >> word && word != "map")
+        {
+            if (word == "height")
+                in >> height;
+
+            else if (word == "width")
+                in >> width;
+        }
+
+        if (word != "map" || width <= 0 || height <= 0)
+            return false;
+
+        string line;
+        std::getline(in, line);
+
+        for (int i = 0; i < height; i++)
+        {
+            if (!std::getline(in, line) || line.size() < width)
+                return false;
+
+            for (int j = 0; i < tilesY && j < std::min(width, tilesX); j++)
+            {
+                blocked[i * tilesX + j] = line[j] != '.' && line[j] != 'G' && line[j] != 'S' && !isdigit((unsigned char)line[j]);
+
+                if (line[j] == 'S')
+                    costs[i * tilesX + j] = swampCost;
+
+                else if (isdigit((unsigned char)line[j]))
+                    costs[i * tilesX + j] = line[j] - '0';
+            }
+        }
+    }
+
+    // The layout is applied with no source or destination, so that none of its obstacles are skipped.
+    clearShortestPath();
+
+    if (source != nullptr)
+        source->setTileColor(restingColor(source->index));
+
+    if (destin != nullptr)
+        destin->setTileColor(restingColor(destin->index));
+
+    source = nullptr;
+    destin = nullptr;
+    setObstacleLayout(blocked);
+    setTerrainLayout(costs);
+
+    if (src != -1 && dest != -1)
+        setQuery(src, dest);
+
+    return true;
+}
+
+bool Board::saveObstacleMap(const string& path)
+{
+    /*
+    Saves the obstacle layout and terrain of the whole board.  A path ending in ".map" gets the MovingAI text format,
+    with '@' for obstacles and '.' for free tiles, which has no place for the source and destination.  Terrain is
+    written as 'S' for swampCost and as the digit of any other cost but 1.  Any other path gets the binary format:
+    an ObstacleMapHeader, with the source and destination, then one bit per tile (1 for an obstacle), row by row,
+    lowest bit first, with each row padded to a whole byte, then the terrain cost of every tile, one byte each.
+    */
+    bool movingAI = path.size() >= 4 && path.compare(path.size() - 4, 4, ".map") == 0;
+    std::ofstream out(path, movingAI ? std::ios::out : std::ios::binary);
+
+    if (!out)
+        return false;
+
+    if (movingAI)
+    {
+        out << "type octile\nheight " << tilesY << "\nwidth " << tilesX << "\nmap\n";
+
+        for (int i = 0; i < tilesY; i++)
+        {
+            string row(tilesX, '.');
+
+            for (int j = 0; j < tilesX; j++)
+            {
+                int cost = terrainCost[i * tilesX + j];
+
+                if (obstacleMask[i * tilesX + j])
+                    row[j] = '@';
+
+                else if (cost == swampCost)
+                    row[j] = 'S';
+
+                else if (cost != 1)
+                    row[j] = '0' + cost;
+            }
+
+            out << row << "\n";
+        }
+    }
+
+    else
+    {
+        ObstacleMapHeader header = {{'B', 'F', 'S', 'O'}, obstacleMapVersion, tilesX, tilesY, source != nullptr ? source->index : -1, destin != nullptr ? destin->index : -1};
+        vector<unsigned char> row((tilesX + 7) / 8);
+        out.write((const char*)&header, sizeof(header));
+
+        for (int i = 0; i < tilesY; i++)
+        {
+            std::fill(row.begin(), row.end(), 0);
+
+            for (int j = 0; j < tilesX; j++)
+                row[j / 8] |= obstacleMask[i * tilesX + j] << (j % 8);
+
+            out.write((const char*)row.data(), row.size());
+        }
+
+        out.write((const char*)terrainCost.data(), terrainCost.size());
+    }
+
+    return bool(out);
+}
+
+int Board::runQuery(GraphType type)
+{
+    /*
+    Runs the given engine on the current source and destination, exactly as clicking the Go button would.
+    Returns the number of moves in the shortest path, or -1 if no path exists.
+    */
+    if (source == nullptr || destin == nullptr || type == GraphType::None)
+        return -1;
+
+    clearShortestPath();
+    int* p = cachedPath(type, bidirectional);
+
+    if (p == nullptr)
+    {
+        p = runEngine(type, bidirectional);
+        cachePath(type, bidirectional, p);
+    }
+
+    displayShortestPath(p);
+
+    if (shortestPath[0] == nullptr)
+        return -1;
+
+    return shortestPath.size();
+}
+
+void Board::setCacheEnabled(bool on)
+{
+    /*
+    Switches the path cache on or off.  Switching it off also empties it and zeroes the hit and miss counts.
+    */
+    cacheEnabled = on;
+
+    if (!on)
+    {
+        cacheEntries.clear();
+        cacheIndex.clear();
+        cacheHits = 0;
+        cacheMisses = 0;
+    }
+}
+
+long long Board::cacheHitCount()
+{
+    /*
+    Returns the number of queries answered from the path cache.
+    */
+    return cacheHits;
+}
+
+void Board::setBidirectional(bool on)
+{
+    /*
+    Switches the bidirectional mode on or off, the same as clicking the bidirectional mode text.
+    */
+    bidirectional = on;
+}
+
+void Board::setDirectionThresholds(int alpha, int beta)
+{
+    /*
+    Sets the switching thresholds of the direction-optimizing engine.  See shortestPathDirOpt.
+    */
+    dirAlpha = std::max(alpha, 1);
+    dirBeta = std::max(beta, 1);
+}
+
+vector<LevelStats> Board::lastLevelStats()
+{
+    /*
+    Returns the per-level statistics of the most recent direction-optimizing search.
+    */
+    return levelStats;
+}
+
+QueryStats Board::lastQueryStats()
+{
+    /*
+    Returns the statistics of the most recent query run through runQuery.
+    */
+    return queryStats;
+}
+
+vector<BatchResult> Board::shortestPathsBatch(const vector<pair<int, int>>& queries)
+{
+    /*
+    Answers each {source index, destination index} pair against the current obstacles.  The queries are searched
+    batchWidth at a time with multi-source BFS, so a batch costs about one sweep of the grid per level rather than
+    one BFS per query.  The board's own source, destination and shortest path are not changed.
+    */
+    auto start = high_resolution_clock::now();
+    vector<BatchResult> results(queries.size());
+    nodesExpanded = 0;
+
+    // Queries whose sources are close together share most of their frontiers, so batch them in order of source
+    // index (row by row), then put the answers back in the caller's order.
+    vector<int> order(queries.size());
+
+    for (int k = 0; k < order.size(); k++)
+        order[k] = k;
+
+    std::stable_sort(order.begin(), order.end(), [&](int a, int b) { return queries[a].first < queries[b].first; });
+    vector<pair<int, int>> sorted(queries.size());
+    vector<BatchResult> sortedResults(queries.size());
+
+    for (int k = 0; k < order.size(); k++)
+        sorted[k] = queries[order[k]];
+
+    for (int first = 0; first < sorted.size(); first += batchWidth)
+    {
+        int count = std::min<int>(batchWidth, sorted.size() - first);
+        multiSourceBatch(sorted.data() + first, count, sortedResults.data() + first);
+    }
+
+    for (int k = 0; k < order.size(); k++)
+        results[order[k]] = std::move(sortedResults[k]);
+
+    auto stop = high_resolution_clock::now();
+    duration = stop - start;
+
+    return results;
+}
+
+void Board::setGridConnectivity(int conn)
+{
+    /*
+    Sets the moves of the grid engines: 4 for orthogonal moves only, anything else for all 8 neighbors, as on the
+    board.
+    */
+    gridConnectivity = conn == 4 ? 4 : 8;
+}
+
+void Board::setThreads(int n)
+{
+    /*
+    Sets the number of threads used by the parallel engine, including the calling thread.  The pool is started again
+    with the new number of workers on the next parallel search.
+    */
+    numThreads = std::max(n, 1);
+}
+
+bool Board::saveSnapshot(const string& path)
+{
+    /*
+    Writes the graph to path as a snapshot: a SnapshotHeader, then csrOffsets, csrTargets and obstacleMask exactly as
+    they are laid out in memory, so that loadSnapshot can use the file without parsing it.  The numbers are written
+    in the machine's own byte order.
+    */
+    std::ofstream out(path, std::ios::binary);
+
+    if (!out)
+        return false;
+
+    SnapshotHeader header = {{'B', 'F', 'S', 'G'}, snapshotVersion, tilesX, tilesY, (uint32_t)indexToTile.size(), (uint32_t)csrTargets.size()};
+    out.write((const char*)&header, sizeof(header));
+    out.write((const char*)csrOffsets.data(), csrOffsets.size() * sizeof(int));
+    out.write((const char*)csrTargets.data(), csrTargets.size() * sizeof(int));
+    out.write(obstacleMask.data(), obstacleMask.size());
+
+    return bool(out);
+}
+
+bool Board::loadedFromSnapshot()
+{
+    /*
+    Returns true if the constructor loaded the graphs from a snapshot rather than building them.
+    */
+    return snapshotLoaded;
+}
+
+double Board::setupTime()
+{
+    /*
+    Returns the time the constructor took to build or load the graphs, in milliseconds.
+    */
+    return setupDuration.count();
+}
+
+double Board::lastDuration()
+{
+    /*
+    Returns the time taken by the most recent search, in milliseconds.
+    */
+    return duration.count();
+}
+
+long long Board::lastNodesExpanded()
+{
+    /*
+    Returns the number of tiles taken off the queue by the most recent search.
+    */
+    return nodesExpanded;
 }
\ No newline at end of file
@@ -5,7 +5,8 @@ or starting tile, and a destination, or ending tile.  The user can also select a
 be reached or traversed.  The user can also select one of two graph implementations: a graph implemented as a map, 
 or a graph implemented as a linked list (LL).  After finding the shortest path, the program will highlight the shortest
 path found and display the time taken for the algorithm to finish.  This way, the user can compare which graph
-implementation allowed for a faster path retrieval.  The user can also reset the board to "play again".
+implementation allowed for a faster path retrieval.  Additional engines that have no image button (such as the flat,
+compressed sparse row (CSR) graph) are listed as clickable text at the bottom of the side panel.  The user can also reset the board to "play again".
 Note that "tiles" and "vertices" will be used interchangeably.
 */
 
@@ -13,9 +14,18 @@ Note that "tiles" and "vertices" will be used interchangeably.
 #include <SFML/Graphics.hpp>
 #include <map>
 #include <set>
+#include <list>
+#include <tuple>
 #include <string>
 #include <vector>
 #include <chrono>
+#include <cstdint>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <memory>
 
 using std::map;
 using std::set;
@@ -29,24 +39,72 @@ const int tilesX = 250; // Number of tiles in each row.  Normally 250, but 25 to
 const int tilesY = 250; // Number of rows of tiles.  Normally 250.
 const float xSize = (1710.f / tilesX) - 1; // Length of each tile.
 const float ySize = (1080.f / tilesX) - 1; // Height of each tile.
+const bool gridLines = true; // True to draw red lines between the tiles.  They are less than a pixel wide on very large boards.
+
+const int bitWordsPerRow = ((tilesX + 63) / 64 + 3) / 4 * 4; // 64-bit words per bitboard row, rounded up to a whole AVX2 register (4 words).
+const int bitStride = bitWordsPerRow + 2; // Words per bitboard row, plus one zero word on each side so shifts can read past either end of a row.
+const int bitBoardWords = (tilesY + 2) * bitStride; // Words per bitboard, plus one zero row above and below the board.
+
+enum class GraphType { None, LinkedList, Map, Flat, Bitboard, DirectionOptimizing, Parallel, Incremental, DistanceField, JumpPoint, AStar, Hierarchical, Specialized, RuntimeGrid, Weighted }; // Graph implementation (search engine) selected by the user.
+
+struct LevelStats // What the direction-optimizing engine did at one BFS level.
+{
+    int level; // Distance of the level's tiles from the source.
+    bool bottomUp; // True if the level was expanded bottom-up, false if top-down.
+    int frontierSize; // Number of tiles in the level.
+    long long edgesChecked; // Number of edges looked at while expanding the level.
+};
+
+struct QueryStats // What one query did, phase by phase (see Board::lastQueryStats).
+{
+    double seekMs = 0; // Time spent finding the source and destination before searching, in milliseconds.  Only the linked list engines seek.
+    double searchMs = 0; // Time spent searching, in milliseconds.  For a cache hit, the time taken to look the path up.
+    double reconstructMs = 0; // Time spent reading the path back from the parents and coloring it, in milliseconds.
+    long long dequeued = 0; // Tiles taken off the queue (jump points for jump point search).
+    long long edgesScanned = -1; // Neighbors looked at.  -1 if the engine does not count them.
+    long long peakQueue = -1; // Largest number of tiles waiting in the queue at once.  -1 if the engine does not track it.
+    int pathLength = -1; // Number of moves in the path, -1 if no path exists.
+    bool cached = false; // True if the path came from the path cache, so no search ran.
+    long long cycles = -1; // CPU cycles spent in the engine (Linux perf_event_open).  -1 if hardware counters are not available.
+    long long instructions = -1; // Instructions retired in the engine.  -1 if not available.
+    long long llcMisses = -1; // Last level cache misses in the engine.  -1 if not available.
+    long long branchMisses = -1; // Mispredicted branches in the engine.  -1 if not available.
+};
+
+struct BatchResult // Answer to one query of a batch (see Board::shortestPathsBatch).
+{
+    int distance; // Number of moves in the shortest path, or -1 if no path exists.
+    vector<int> path; // Indices of the tiles on the path, from source to destination.  Empty if no path exists.
+};
+
+const int incInfinity = 1 << 29; // Incremental engine: distance of a tile that cannot be reached.
+const int hpaClusterSize = 16; // Hierarchical engine: width and height of a cluster, in tiles.
+const int hpaClustersX = (tilesX + hpaClusterSize - 1) / hpaClusterSize; // Hierarchical engine: clusters in each row.  The last may be narrower.
+const int hpaClustersY = (tilesY + hpaClusterSize - 1) / hpaClusterSize; // Hierarchical engine: rows of clusters.  The last may be shorter.
+const int batchWidth = 64; // Queries searched together by the batch engine: one bit of a 64-bit word per query.
+const uint32_t snapshotVersion = 1; // Version of the graph snapshot file format.  A snapshot of any other version is ignored and rebuilt.
+const double animationBudgetMs = 1.0; // Animated search: longest time spent searching in one frame, in milliseconds.
+const int animationTilesPerFrame = 256; // Animated search: most tiles expanded in one frame, so the frontier can be watched as it grows.
+const int laneTiles = 16; // Linked list express lanes: tiles skipped by one hop along a row.
+const int laneRows = 16; // Linked list express lanes: rows skipped by one hop of the widest lane.
+const uint32_t obstacleMapVersion = 2; // Version of the binary obstacle layout format written by Board::saveObstacleMap.  Version 1 files, without terrain, are still read.
+const int maxTerrainCost = 9; // Highest cost of entering a tile.  Plain ground costs 1, a preferred lane 0.
+const int swampCost = 3; // Terrain cost of a swamp tile ('S') in a MovingAI map.
 
 class Board
 {
-    struct Tile
+    struct Tile // One square of the board.  Holds only what drawing needs: obstacle, source and destination state is kept per index on the Board.
     {
-        sf::RectangleShape tile; // The SFML rectangle object.
-        sf::Vector2f tilePosition;
-        bool isSource; // True if tile is the source (i.e. starting tile), false otherwise.
-        bool isDest; // True if tile is the destination (i.e. end tile), false otherwise.
-        bool isObst; // True if the tile is an obstacle, false otherwise.
+        sf::Vertex* quad; // The tile's four corners in Board::tileVertices.
+        bool* redraw; // Board::needsRedraw, set whenever the tile's color changes.
         int index; // Unique for each vertex. Goes from 0 to (number of vertices - 1), left to right for each row.
         Tile();
-        void setTileColor(sf::Color c); // Sets fill color.  Black for unselected tile, Magenta for obstacle, Green for source, Red for destination. 
+        void setTileColor(sf::Color c); // Sets fill color.  Black for unselected tile, Magenta for obstacle, Green for source, Red for destination, blue and cyan for an animated search. 
     };
 
     struct Node // Linked list implementation of the graph will consist of these Nodes.  Each node points to its nearest neighbor nodes.
     {
-        Tile* tPtr; // Each node has a tile pointer as a value.
+        int index; // Index of the node's tile.  Searches read obstacleMask[index], never the tile itself.
         Node* right = nullptr; // Node directly to the right.
         Node* left = nullptr; // Node directly to the left.
         Node* up = nullptr; // Node directly above.
@@ -55,13 +113,76 @@ class Board
         Node* topRight = nullptr; // Node up and to the right.
         Node* botLeft = nullptr; // Node below and to the left.
         Node* botRight = nullptr; // Node below and to the right.
-        Node(Tile* t) : tPtr(t) {}
+        Node* skipRows = nullptr; // Express lane: on the first node of every laneRows-th row, in serpentine order, the first node laneRows rows on.
+        Node* skipRow = nullptr; // Express lane: on the first node of each row, in serpentine order, the first node of the next row.
+        Node* skipTiles = nullptr; // Express lane: on every laneTiles-th node of a row, in serpentine order, the node laneTiles further along it.
+        Node(Tile* t) : index(t->index) {}
+    };
+
+    struct AnimatedSearch // A breadth first search that runs a slice at a time between frames, in the search workspace.
+    {
+        bool active = false; // True while a search is in progress.
+        int head = 0; // Next entry of Board::workQueue to expand.
+        int tail = 0; // One past the last entry of Board::workQueue.
+        bool endFound = false; // True once the destination has been reached.
+        long long edges = 0; // Neighbors looked at so far.
+        int peak = 0; // Largest number of tiles waiting in the queue so far.
+        std::chrono::duration<double, std::milli> compute{0}; // Time spent searching, without the time spent coloring and drawing.
+        high_resolution_clock::time_point started; // When the search started, for the time it was on screen.
+    };
+
+    struct HpaCluster // One cluster of the hierarchical engine's abstract graph.
+    {
+        vector<int> nodes; // Tiles of the cluster that are ends of transitions to neighboring clusters.
+        vector<vector<int>> partners; // partners[k] holds the tiles in neighboring clusters that nodes[k] has a transition to.
+        vector<int> dist; // dist[a * nodes.size() + b] is the number of moves from nodes[a] to nodes[b] inside the cluster, -1 if there is no way.
+        bool dirty = true; // True if the cluster must be rebuilt before the next query.
+    };
+
+    struct SnapshotHeader // Start of a graph snapshot file.  It is followed by csrOffsets, csrTargets and obstacleMask, as stored in memory.
+    {
+        char magic[4]; // Always "BFSG".
+        uint32_t version; // snapshotVersion when the file was written.
+        uint32_t width; // tilesX when the file was written.
+        uint32_t height; // tilesY when the file was written.
+        uint32_t vertices; // Number of tiles, and of entries in the obstacle layer.  csrOffsets has one more entry.
+        uint32_t edges; // Number of entries in csrTargets.
+    };
+
+    struct ObstacleMapHeader // Start of a binary obstacle layout file.  It is followed by one bit per tile, each row padded to a whole byte, then one terrain cost byte per tile.
+    {
+        char magic[4]; // Always "BFSO".
+        uint32_t version; // obstacleMapVersion when the file was written.
+        uint32_t width; // Number of columns of the layout.
+        uint32_t height; // Number of rows of the layout.
+        int32_t source; // Index (row * width + column) of the source tile, -1 if none.
+        int32_t destination; // Index of the destination tile, -1 if none.
     };
 
     private:
         map<Tile*, set<Tile*>> graphMap; // Map implementation of graph.  Maps from Tile pointer to set of Tile pointers which are the nearest neighbors.
+        vector<Tile> tilePool; // Every tile, in index order, in one block.  Never resized after makeGraphs, so Tile pointers stay valid.
+        vector<Node> nodePool; // Every linked list node, in index order, in one block.  Never resized after makeGraphs.
         Node* head; // Head node of linked list (LL) graph implementation.  It will always point to the tile at index 0 (row 0, column 0).
         map<pair<int, int>, pair<Tile*, Node*>> posToTile; // Map from {i, j} grid position to its associated Tile and Node. 
+        bool needsRedraw; // True if the window must be redrawn, because a tile color, text or button changed.  Cleared after each redraw.
+        sf::VertexArray tileVertices; // One quad per tile, four vertices each, in index order.  Drawn in one call.
+        sf::VertexArray gridBackdrop; // Red quad behind the tiles.  Shows through the gaps between tiles as grid lines.
+        vector<Tile*> indexToTile; // Tile at each index.  Avoids a posToTile lookup when only the index is known.
+        vector<int> csrOffsets; // Flat (CSR) graph: neighbors of vertex u are csrTargets[csrOffsets[u]] to csrTargets[csrOffsets[u + 1] - 1].
+        vector<int> csrTargets; // Flat (CSR) graph: neighbor indices of every vertex, stored back to back.
+        vector<char> obstacleMask; // obstacleMask[u] is 1 if the tile at index u is an obstacle, 0 otherwise.
+        vector<char> paddedBlocked; // Obstacle flags with a ring of blocked tiles around the board.  Tile {i, j} is at (i + 1) * (tilesX + 2) + j + 1.
+        int gridWidth; // Width of the grid seen by the run-time sized grid engine.  Always tilesX.
+        int gridHeight; // Height of the grid seen by the run-time sized grid engine.  Always tilesY.
+        int gridConnectivity; // Grid engines: 8 for the board's moves, or 4 for orthogonal moves only (set by the benchmark).
+        vector<int> gridQueue; // Grid engines: BFS queue of padded indices, reused between searches.
+        vector<int> gridFrom; // Grid engines: parent of each padded index, valid where gridSeen is gridEpoch.
+        vector<uint32_t> gridSeen; // Grid engines: gridSeen[v] == gridEpoch if padded index v has been reached by the current search.
+        uint32_t gridEpoch; // Grid engines: stamp of the current search.
+        vector<uint64_t> bitLevels; // Bitboard engine: the rows spanned by each BFS level of the last search, back to back.  Kept to reuse its memory.
+        vector<pair<int, int>> bitLevelRows; // Bitboard engine: first and last bitboard row stored in bitLevels for each level.
+        vector<uint64_t> freeBits; // Bitboard of tiles that are not obstacles.  Tile {i, j} is bit j % 64 of word (i + 1) * bitStride + 1 + j / 64.
         set<Tile*> obstacles; // Set of obstacle tiles.
         vector<Tile*> shortestPath; // Vector of tiles where each tile is part of the shortest path.
         sf::Text text1; // Text prompting user to select source/destination.
@@ -85,27 +206,212 @@ class Board
         sf::Texture mapTexture; // Map button associated texture.
         sf::Sprite tryAgainSprite; // Sprite representing Try Again button.
         sf::Texture tryAgainTexture; // Try Again button associated texture.
-        duration<double, std::milli> duration; // Time taken by algorithm.
-        bool mapSelected; // True if map implementation was selected, false otherwise.
-        bool linkedListSelected; // True if linked list implementation was selected, false otherwise.
+        sf::Text text12; // Heading of the list of engines that have no image button.
+        map<GraphType, sf::Text> engineText; // Clickable text button for each engine that has no image button.
+        sf::Text bidirectionalText; // Clickable text that switches the bidirectional mode on and off.
+        sf::Text text13; // Text showing each of the extra result lines.
+        sf::Text text14; // Text showing how long the graphs took to build or load from the snapshot.
+        vector<string> resultLines; // Extra result lines (comparisons and statistics) shown under the engine list after a run.
+        std::chrono::duration<double, std::milli> duration; // Time taken by algorithm.
+        long long nodesExpanded; // Number of tiles taken off the queue by the most recent search.
+        bool bidirectional; // True if the bidirectional mode is switched on.  Only engines with a bidirectional version use it.
+        int dirAlpha; // Direction-optimizing engine: go bottom-up once the frontier's edges exceed 1/dirAlpha of the unexplored edges.
+        int dirBeta; // Direction-optimizing engine: go back to top-down once the frontier holds fewer than 1/dirBeta of the tiles.
+        vector<LevelStats> levelStats; // Direction-optimizing engine: statistics of every level of the most recent search.
+        int numThreads; // Parallel engine: number of threads searching, including the calling thread.
+        vector<std::thread> parWorkers; // Parallel engine: pool of numThreads - 1 worker threads, kept alive between searches.
+        std::mutex parMutex; // Parallel engine: guards parJob and parQuit.
+        std::condition_variable parWake; // Parallel engine: the workers sleep on it between searches.
+        long long parJob; // Parallel engine: number of searches handed to the pool.  Each increment wakes the workers for one search.
+        bool parQuit; // Parallel engine: true when the workers must exit.
+        std::function<void(int)> parWork; // Parallel engine: the current search's work for worker w.
+        std::atomic<int> parRunning; // Parallel engine: workers still working on the current search.
+        vector<int> parLevels[2]; // Parallel engine: the current and next BFS levels, reused between searches.
+        vector<vector<int>> parLocal; // Parallel engine: each thread's part of the next level, reused between searches.
+        std::unique_ptr<std::atomic<int>[]> parCursor; // Parallel engine: next chunk of the current level in each thread's share.
+        vector<int> parChunkEnd; // Parallel engine: end of each thread's share of the current level's chunks.
+        vector<uint64_t> batchSeen; // Batch engine: bit q of batchSeen[u] is set once query q of the batch has reached tile u.
+        vector<uint64_t> batchVisit; // Batch engine: bit q of batchVisit[u] is set if u is in query q's current frontier.
+        vector<uint64_t> batchVisitNext; // Batch engine: as batchVisit, for the next level.
+        vector<char> batchParent; // Batch engine: direction to the parent of tile u for query q, at u * batchWidth + q.
+        vector<int> incG; // Incremental engine: distance from the source found by the last search (g in LPA*).
+        vector<int> incRhs; // Incremental engine: one-step lookahead distance from the neighbors' g values (rhs in LPA*).
+        vector<pair<pair<int, int>, int>> incOpen; // Incremental engine: min-heap of {key, tile}.  Entries whose key is out of date are skipped.
+        vector<int> incChanged; // Incremental engine: tiles whose obstacle state changed since the last search.
+        int incSource; // Incremental engine: source index the kept state belongs to, -1 if there is no kept state.
+        int incDest; // Incremental engine: destination index the kept state belongs to.
+        typedef std::tuple<int, int, int, bool, int, uint64_t, uint64_t> CacheKey; // Path cache key: {source, destination, engine, bidirectional, moves, obstacleHash, terrainHash or 0}.
+        std::list<pair<CacheKey, vector<int>>> cacheEntries; // Path cache: cached paths (destination back to source, empty if none), most recently used first.
+        map<CacheKey, std::list<pair<CacheKey, vector<int>>>::iterator> cacheIndex; // Path cache: position of each key in cacheEntries.
+        int cacheCapacity; // Path cache: most paths kept before the least recently used is evicted.
+        bool cacheEnabled; // Path cache: true if queries are looked up in and stored to the cache.
+        long long cacheHits; // Path cache: number of queries answered from the cache.
+        long long cacheMisses; // Path cache: number of queries that had to be searched.
+        vector<uint64_t> tileKeys; // Random key of every tile.  The obstacle hash is the XOR of the keys of all obstacles.
+        uint64_t obstacleHash; // XOR of tileKeys of all obstacles, kept up to date by setObstacle and setObstacleLayout.
+        uint64_t terrainHash; // XOR of terrainKey of every tile not on plain ground, kept up to date by setTerrain.
+        long long jpsScanned; // Jump point search: tiles stepped over by the jumps of the most recent search.
+        vector<vector<int>> astarBuckets; // A* engine: open list, one stack of tiles per f value.
+        vector<unsigned char> terrainCost; // Cost of entering each tile, 0 to maxTerrainCost.  1 on plain ground.  Only the weighted engine reads it.
+        int heavyTiles; // Number of tiles whose terrain costs more than 1.  With none, the weighted engine runs 0-1 BFS.
+        int terrainTiles; // Number of tiles whose terrain costs anything but 1.  With none, the cheapest path is a shortest path.
+        int terrainBrush; // Terrain cost painted by right-clicks, or -1 when right-clicks paint obstacles.
+        sf::Text terrainText; // Clickable text that shows and changes the terrain brush.
+        vector<vector<int>> dialBuckets; // Weighted engine: bucket queue, one bucket per distance modulo maxTerrainCost + 1.
+        vector<int> dialDist; // Weighted engine: terrain cost from the source to each tile reached by the current search.
+        int pathCost; // Weighted engine: terrain cost of the path found by the most recent search, -1 if none.
+        vector<HpaCluster> hpaClusters; // Hierarchical engine: clusters, row by row.
+        vector<int> hpaNodeSlot; // Hierarchical engine: position of tile u in its cluster's nodes, -1 if u is no transition tile.
+        vector<int> hpaG; // Hierarchical engine: distance of each abstract vertex during a search.  incInfinity when untouched.
+        vector<int> hpaParent; // Hierarchical engine: previous abstract vertex of each abstract vertex during a search.
+        int hpaRebuilt; // Hierarchical engine: clusters rebuilt by the most recent query.
+        vector<int> fieldDist; // Distance field: moves from fieldSource to every tile, -1 if the tile can't be reached.
+        vector<int> fieldParent; // Distance field: parent of every reached tile on a shortest path from fieldSource.
+        int fieldSource; // Distance field: source index the field was built from, -1 if there is no field.
+        int fieldReached; // Distance field: number of tiles reached from fieldSource.
+        int fieldMaxDist; // Distance field: distance of the farthest reached tile.
+        std::chrono::duration<double, std::milli> fieldDuration; // Distance field: time taken to build it.
+        vector<Tile*> hoverPath; // Distance field: tiles of the path to the hovered tile, excluding its ends.
+        int hoverIndex; // Distance field: index of the hovered tile whose path is shown, -1 if none.
+        bool heatMap; // True if the heat map of the distance field is switched on.
+        bool heatPainted; // True if the tiles currently show the heat map colors.
+        sf::Text heatMapText; // Clickable text that switches the heat map on and off.
+        bool animate; // True if Go animates the search instead of running it in one go.  Only the map, LL and flat engines are animated.
+        sf::Text animateText; // Clickable text that switches animate on and off.
+        AnimatedSearch animation; // The animated search in progress, if any.
+        GraphType graphType; // Graph implementation selected by the user.  GraphType::None until one is selected.
         bool goButtonClicked; // True when Go button is clicked.  Becomes false when program starts and when board is reset.
         bool tryAgainClicked; // True when Try Again button is clicked.  Is false when program starts and after reset is selected.
         Tile* source; // Source tile, as selected by user.
         Tile* destin; // Destination tile, as selected by user.
+        bool snapshotLoaded; // True if the graphs were loaded from a snapshot file rather than built.
+        std::chrono::duration<double, std::milli> setupDuration; // Time taken to build or load the graphs in the constructor.
+        QueryStats queryStats; // Statistics of the most recent query.  Filled by runEngine (or cachedPath) and displayShortestPath.
+        int perfFds[4]; // perf_event_open counters for cycles, instructions, LLC misses and branch misses, -1 where not open.
+        bool perfOpened; // True once opening the hardware counters has been tried.
+        vector<int> workQueue; // Search workspace: BFS queue of the map and linked list engines.  Each tile is queued at most once per search.
+        vector<int> workParent; // Search workspace: parent of each tile reached by the current search.  Returned as p and kept by the board.
+        vector<uint32_t> workVisited; // Search workspace: workVisited[u] == workEpoch if tile u has been reached by the current search.
+        vector<int> biParentBack; // Bidirectional engines: parent of each tile reached from the destination, towards the destination.
+        vector<char> biSide; // Bidirectional engines: 1 if a tile was reached from the source, 2 from the destination.  Valid where workVisited is current.
+        vector<int> biFrontier[3]; // Bidirectional engines: frontier[1] from the source, frontier[2] from the destination, frontier[0] the next level.
+        uint32_t workEpoch; // Search workspace: stamp of the current search.  Advancing it unmarks every tile at once.
         void makeGraphs(); // Constructs both graph implementations.  Runs in the Board constructor.
+        void makeTiles(); // Allocates every tile and node and fills posToTile, graphMap (with no edges yet) and indexToTile.
+        void makeSearchState(); // Builds the linked list express lanes, freeBits, paddedBlocked, the obstacle hash keys and the hierarchical clusters.  Runs after the graphs are built.
+        bool loadSnapshot(const string& path); // Builds the graphs from a snapshot file instead of makeGraphs.  False if there is no valid snapshot.
         void insertEdges(int i, int j); // Inserts edges from tile at position {i, j} to its (up to) 8 nearest neighbors.
         void setLLPointers(int i, int j); // Sets the (up to) 8 pointers of each linked list node to its nearest neighbors.
+        void makeVertices(); // Builds tileVertices and gridBackdrop and points each tile at its quad.  Runs in makeGraphs.
+        void makeFlatGraph(); // Packs graphMap into the contiguous csrOffsets/csrTargets arrays.  Runs after makeGraphs.
+        void makeBitboard(); // Sets every tile's bit in freeBits.  Runs after makeGraphs.
+        void makePaddedGrid(); // Builds paddedBlocked from obstacleMask.  Runs after makeGraphs.
+        void setObstacle(Tile* t, bool isObstacle); // Marks or unmarks t as an obstacle, keeping obstacles and obstacleMask in sync.
+        void setObstacleLayout(const vector<char>& blocked); // Replaces the whole obstacle layout in one pass.  blocked has one entry per tile.
+        string engineName(GraphType type); // Name of an engine as shown in the side panel.
+        GraphType engineClicked(sf::Vector2i position); // Engine whose text button is at position, GraphType::None if there is none.
         void displayBoard(sf::RenderWindow& window); // Displays the current state of the board to the user.
         void displayText(sf::RenderWindow& window); // Displays the text to the user.
+        void beginSearch(); // Starts a search in the workspace: sizes its arrays on first use and advances workEpoch.
+        void releasePath(int* p); // Frees a p array returned by an engine, unless it is the workspace's workParent.
         int* shortestPathGraph(); // Finds the shortest path for the map implementation.
-        Node* traverseLL(int index); // Traverses linked list from head node to node at index.
+        void makeExpressLanes(); // Sets the skipRows, skipRow and skipTiles pointers of the linked list nodes.
+        Node* traverseLL(int index); // Traverses linked list from head node to node at index, taking the express lanes.
         int* shortestPathLL(); // Finds the shortest path for the linked list implementation.
         int* shortestPathNodes(Node* start, Node* end); // Main function for finding the shortest path for the linked list implementation.
+        int* shortestPathFlat(); // Finds the shortest path for the flat (CSR) implementation.
+        template <int W, int H, int Conn>
+        int* shortestPathGrid(int width, int height); // BFS on paddedBlocked, specialized for a W x H grid with Conn (4 or 8) neighbors.  W = H = 0 uses width and height.
+        int* shortestPathSpecialized(); // Finds the shortest path with shortestPathGrid specialized for tilesX x tilesY and gridConnectivity.
+        int* shortestPathRuntimeGrid(); // Finds the shortest path with the run-time sized version of shortestPathGrid and gridConnectivity.
+        int* shortestPathBits(); // Finds the shortest path for the bitboard implementation, expanding a whole BFS level at a time.
+        int* shortestPathDirOpt(); // Finds the shortest path with direction-optimizing (top-down / bottom-up) BFS on the CSR arrays.
+        void multiSourceBatch(const pair<int, int>* queries, int count, BatchResult* results); // Answers up to batchWidth queries in one multi-source BFS.
+        pair<int, int> incKey(int u); // Incremental engine: priority of tile u, {min(g, rhs) + distance to destination, min(g, rhs)}.
+        void incUpdateTile(int u); // Incremental engine: recomputes rhs of u and queues u if it is inconsistent (g != rhs).
+        int* shortestPathIncremental(); // Finds the shortest path with LPA*, repairing the previous search after obstacle changes.
+        bool jpsFree(int i, int j); // Jump point search: true if {i, j} is on the board and not an obstacle.
+        int jpsJump(int i, int j, int di, int dj, int dest); // Jump point search: index of the next jump point from {i, j} in direction {di, dj}, -1 if none.
+        int* shortestPathJPS(); // Finds the shortest path with jump point search, expanding only jump points.
+        uint64_t terrainKey(int u, int cost); // What tile u with the given terrain cost adds to terrainHash.  0 on plain ground.
+        void setTerrain(Tile* t, int cost); // Sets the terrain cost of tile t, keeping heavyTiles, terrainTiles and terrainHash up to date, and recolors it.
+        sf::Color terrainColor(int u); // Color of free tile u from its terrain cost: black on plain ground.
+        int* shortestPathWeighted(); // Finds the cheapest path over the terrain costs: 0-1 BFS when no tile costs more than 1, otherwise Dial's algorithm.
+        int* shortestPathZeroOne(); // Weighted engine: 0-1 BFS, for terrain costs of 0 and 1 only.
+        int* shortestPathDial(); // Weighted engine: Dial's algorithm, Dijkstra with a bucket queue indexed by cost.
+        int* shortestPathAStar(); // Finds the shortest path with A* (Chebyshev heuristic) and a bucketed open list.
+        void hpaClusterBFS(int c, int start, vector<int>& dist, vector<int>& parent); // Hierarchical engine: BFS from start that stays inside cluster c.
+        void hpaBorder(int c1, int c2, vector<pair<int, int>>& out); // Hierarchical engine: appends the transitions between neighboring clusters c1 and c2.
+        void hpaMarkDirty(int u); // Hierarchical engine: marks the clusters whose transitions or distances tile u affects for rebuilding.
+        void hpaRebuildCluster(int c); // Hierarchical engine: recomputes the transitions and inner distances of cluster c.
+        int* shortestPathHPA(); // Finds a path with hierarchical pathfinding (HPA*): A* over clusters, then refined inside each.
+        void buildDistanceField(int src); // Runs a full BFS from src and keeps every tile's distance and parent in the distance field.
+        int* shortestPathField(); // Finds the shortest path by reading it back from the source's distance field, building the field if needed.
+        sf::Color restingColor(int u); // Color of free tile u when it is not on a path: its heat map color, or its terrain color.
+        void paintHeatMap(); // Colors the free tiles by distance from the source, or back to black if the heat map is off.
+        void showHoverPath(int index); // Shows the path from the source to the tile at index, read back from the distance field.
+        void clearHoverPath(); // Returns the hover path tiles to their resting color.
+        void clearDistanceField(); // Drops the distance field, its hover path and its heat map.
+        bool canAnimate(GraphType type); // True if the engine's search is the breadth first search that the animation replays.
+        void startAnimation(); // Starts an animated search for the current query.
+        void stepAnimation(); // Expands the animated search for one frame's budget, then colors what it expanded and queued.
+        void finishAnimation(); // Ends the animated search: returns its tiles to their resting color and shows the path and statistics.
+        void clearAnimation(); // Stops the animated search and returns the tiles it colored to their resting color.
+        void cancelAnimation(); // Stops the animated search without a result, so that Go can be pressed again.
+        int* shortestPathParallel(); // Finds the shortest path with level-synchronous BFS on the CSR arrays, spread across numThreads threads.
+        void startWorkers(int count); // Parallel engine: starts a pool of count worker threads.
+        void stopWorkers(); // Parallel engine: wakes the worker threads to exit and joins them.
+        void workerLoop(int w, long long job); // Parallel engine: body of worker w, which sleeps until a search after job is handed out.
+        template <typename Neighbors>
+        int* bidirectionalSearch(int src, int dest, Neighbors neighbors); // BFS from both ends.  neighbors(u, out) writes u's free neighbors to out and returns how many.
+        int* shortestPathGraphBidirectional(); // Bidirectional version of shortestPathGraph.
+        int* shortestPathLLBidirectional(); // Bidirectional version of shortestPathLL.
+        int* shortestPathFlatBidirectional(); // Bidirectional version of shortestPathFlat.
+        bool hasBidirectional(GraphType type); // True if the engine has a bidirectional version.
+        int* dispatchEngine(GraphType type, bool bidirectionalMode); // Calls the shortest path function of the given graph implementation.
+        int* runEngine(GraphType type, bool bidirectionalMode); // Runs the shortest path algorithm of the given graph implementation and records its queryStats.
+        void perfStart(); // Resets and starts the hardware counters, opening them on first use.  Does nothing where they are not available.
+        void perfStop(); // Stops the hardware counters and stores their counts in queryStats.
+        void showQueryStats(); // Appends the statistics of the last query to resultLines.
+        int* runSelectedEngine(); // Runs the selected engine for the Go button and fills resultLines with its statistics.
+        CacheKey cacheKey(GraphType type, bool bidirectionalMode); // Path cache key of the current query.
+        int* cachedPath(GraphType type, bool bidirectionalMode); // p array of the current query from the path cache, nullptr on a miss.
+        void cachePath(GraphType type, bool bidirectionalMode, const int* p); // Stores the path in p for the current query in the path cache.
         void displayShortestPath(int* p); // Uses the shortest path array, p, and displays the shortest path tiles.
+        void clearShortestPath(); // Returns the tiles of the previously found shortest path to black and empties shortestPath.
         void resetBoard(); // Resets board with all selections to default.
 
     public:
-        Board(); // Constructor.
+        Board(const string& snapshotPath = ""); // Constructor.  Loads the graphs from snapshotPath if it holds a valid snapshot, otherwise builds them and writes one there.
         ~Board(); // Destructor.
         void play(sf::RenderWindow& window); // Runs in main.cpp and is responsible for all actions (displays board, accepts input, displays results).
+        bool saveSnapshot(const string& path); // Writes the graph and obstacle layout to a snapshot file.  False if the file could not be written.
+        bool loadedFromSnapshot(); // True if the constructor loaded the graphs from a snapshot.
+        double setupTime(); // Time taken by the constructor to build or load the graphs, in milliseconds.
+
+        // Headless interface used by the benchmark (bench.cpp).  None of these functions need a window.
+        int numTiles(); // Number of tiles (vertices) on the board.
+        bool setQuery(int src, int dest); // Selects source and destination by index.  False if either is an obstacle, out of range, or they are equal.
+        void setObstacleAt(int index, bool isObstacle); // Marks or unmarks one tile as an obstacle.  Ignored for the source and destination.
+        void setObstacles(const vector<int>& indices); // Replaces the obstacle layout.  Indices of the source or destination are skipped.
+        bool obstacleAt(int index); // True if the tile at index is an obstacle.
+        bool loadObstacleMap(const string& path); // Loads an obstacle layout from a MovingAI .map file or a binary layout file.  False if it cannot be read.
+        bool saveObstacleMap(const string& path); // Saves the obstacle layout as a MovingAI .map file if path ends in ".map", otherwise in the binary format.
+        void setTerrainAt(int index, int cost); // Sets the cost of entering one tile, clamped to 0 to maxTerrainCost.
+        void setTerrainLayout(const vector<unsigned char>& costs); // Replaces the terrain cost of every tile.
+        int terrainAt(int index); // Cost of entering the tile at index.
+        int lastPathCost(); // Terrain cost of the path found by the most recent query, whatever the engine, -1 if none.
+        bool flatTerrain(); // True if every tile costs 1 to enter, so that the weighted engine must find shortest paths.
+        void setBidirectional(bool on); // Switches the bidirectional mode on or off for the engines that have one.
+        int runQuery(GraphType type); // Runs an engine on the current query.  Returns the number of moves in the path, or -1 if no path exists.
+        void setDirectionThresholds(int alpha, int beta); // Sets dirAlpha and dirBeta of the direction-optimizing engine.
+        vector<LevelStats> lastLevelStats(); // Per-level statistics of the most recent direction-optimizing search.
+        QueryStats lastQueryStats(); // Phase timings, counters and hardware counts of the most recent query.
+        vector<BatchResult> shortestPathsBatch(const vector<pair<int, int>>& queries); // Answers many {source, destination} index pairs, batchWidth at a time.
+        void setThreads(int n); // Sets the number of threads used by the parallel engine.
+        void setGridConnectivity(int conn); // Sets the grid engines to 4 (orthogonal) or 8 neighbors.  The board and every other engine use 8.
+        void setCacheEnabled(bool on); // Switches the path cache on or off for runQuery.  Switching it off empties the cache.
+        long long cacheHitCount(); // Number of queries answered from the path cache.
+        double lastDuration(); // Time taken by the most recent search, in milliseconds.
+        long long lastNodesExpanded(); // Number of tiles taken off the queue by the most recent search.
 };
\ No newline at end of file
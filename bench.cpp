@@ -0,0 +1,770 @@
+/*
+Headless benchmark for the shortest path engines.  No window is opened: a Board is constructed and its engines are
+run over many source/destination/obstacle scenarios, and the latency percentiles, throughput, nodes expanded and peak
+resident memory of every engine are written as CSV (default) or JSON.
+
+Scenarios either come from a MovingAI scenario file (.scen), or are generated at random from a seed.  The obstacle
+layout comes from --map (a MovingAI .map file or a binary layout saved by Board::saveObstacleMap), or else from the
+map named in the scenario file, looked up next to it.  Maps larger than the board are cut off at its right and bottom
+edges.  Without a map, the layout is random, with the density given by --density.
+
+Usage: bench [--scen file.scen] [--seed n] [--queries n] [--density d] [--engines ll,map,flat,bits,flat-bi,...] [--json] [--out file]
+             [--alpha n] [--beta n] [--level-stats file] [--threads n] [--batch] [--edits n] [--cache] [--per-source n] [--setup] [--snapshot file] [--map file] [--stats file]
+             [--conn 4|8]
+--alpha and --beta set the switching thresholds of the direction-optimizing engine (dirop), and --level-stats
+writes what it did at every level of every query as CSV, for tuning them.  --threads sets the number of threads of
+the parallel engine (par); it defaults to the number of hardware threads.  --conn 4 runs the compile-time and
+run-time grid engines (grid, grid-rt) with the 4-neighbor stencil instead of the board's 8 neighbors.  Their paths
+are then only comparable with each other, so run them alone: --engines grid,grid-rt --conn 4.  --batch also answers all queries through
+the batch (multi-source BFS) interface and reports it as msbfs, with each query charged an equal share of the total time.  --edits n follows every scenario with n single-tile
+obstacle toggles, each followed by a timed re-run of the same query, which is where the incremental engine (inc)
+saves work; the toggles are then undone and the query is run once more on the restored layout.  --cache turns on the
+board's path cache, so that repeated queries on an unchanged layout (repeats in the scenario file, or the run on the
+layout restored after --edits) are answered without searching; cache_hits counts them.
+--per-source n makes the random queries come in runs of n with the same source, the one-to-many pattern where the
+distance field engine (field) builds one field per source and reads every other path back from it.
+
+Every engine's path lengths are checked against the first exact engine.  The hierarchical engine (hpa) is
+approximate: it must agree on whether a path exists, but may find longer paths, which longer_paths counts.  The
+weighted engine (dial) is exact when every tile costs 1.  On a map with terrain (swamp, or the cost digits written by
+Board::saveObstacleMap) the cheapest path may take more moves than the shortest, so its lengths are checked the same
+way as hpa's, and the cost of every path it finds is checked against Dijkstra's algorithm with a binary heap.
+allocs_per_query is the number of heap allocations each query made, counted by the operator new below.
+
+--stats file writes the statistics record of every query as CSV: seek, search and path reconstruction times, tiles
+dequeued, edges scanned, peak queue length, path length, and, on Linux where perf_event_open is allowed, CPU cycles,
+instructions, last level cache misses and branch misses (-1 where an engine or the machine does not provide them).
+
+--setup also constructs and destroys one extra Board, and writes the time each took and the number of allocations
+the constructor made to stderr.  --snapshot file loads the board's graphs from a snapshot file, writing it first if it
+does not exist; with --setup, the time to build the graphs from scratch and the time to load them from the snapshot
+are both written.
+*/
+
+#include "Board.h"
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <algorithm>
+#include <random>
+#include <queue>
+#include <sstream>
+#include <iomanip>
+#include <atomic>
+#include <chrono>
+#include <new>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+using std::cout;
+using std::cerr;
+
+// Every allocation made through new in this process is counted, so that --setup can report how many the Board
+// constructor makes, and the results can report how many each query makes.
+std::atomic<long long> allocationCount(0);
+
+void* operator new(std::size_t size)
+{
+    allocationCount++;
+    void* memory = std::malloc(size > 0 ? size : 1);
+
+    if (memory == nullptr)
+        throw std::bad_alloc();
+
+    return memory;
+}
+
+// The deletes are kept out of line: inlined, GCC sees the free and warns that it does not match the new.
+__attribute__((noinline)) void operator delete(void* memory) noexcept
+{
+    std::free(memory);
+}
+
+__attribute__((noinline)) void operator delete(void* memory, std::size_t) noexcept
+{
+    std::free(memory);
+}
+
+// The array forms are replaced as well, so that every new is matched by a delete of the same family.
+void* operator new[](std::size_t size)
+{
+    return operator new(size);
+}
+
+void operator delete[](void* memory) noexcept
+{
+    operator delete(memory);
+}
+
+void operator delete[](void* memory, std::size_t) noexcept
+{
+    operator delete(memory);
+}
+
+struct Scenario
+{
+    int src; // Index of the source tile.
+    int dest; // Index of the destination tile.
+};
+
+struct EngineResult
+{
+    string name; // Engine name used on the command line.
+    vector<double> times; // Time taken by each query, in milliseconds.
+    long long nodesExpanded = 0; // Total number of tiles taken off the queue over all queries.
+    long peakRssKb = 0; // Peak resident memory of the process after this engine finished, in KB.
+    long long cacheHits = 0; // Number of queries answered from the path cache.
+    vector<int> lengths; // Path length found by each query, -1 if no path was found.
+    vector<int> scenarioLengths; // Path length found by the first query of each answered scenario, before any --edits.
+    bool approximate = false; // True if the engine may find paths longer than the shortest.
+    int longerPaths = 0; // Number of queries whose path was longer than the shortest (approximate engines only).
+    long long allocations = 0; // Number of allocations made by the engine's queries.
+};
+
+struct EngineName
+{
+    string name; // Engine name used on the command line.
+    GraphType type; // Graph implementation.
+    bool bidirectional; // True to run the bidirectional version of the engine.
+    bool approximate = false; // True if the engine may find paths longer than the shortest.
+    bool weighted = false; // True if the engine finds the cheapest path over the terrain costs rather than the shortest.
+};
+
+// Engines that can be benchmarked, by the name used on the command line.
+const vector<EngineName> engineNames = {
+    {"ll", GraphType::LinkedList, false},
+    {"map", GraphType::Map, false},
+    {"flat", GraphType::Flat, false},
+    {"bits", GraphType::Bitboard, false},
+    {"dirop", GraphType::DirectionOptimizing, false},
+    {"par", GraphType::Parallel, false},
+    {"inc", GraphType::Incremental, false},
+    {"field", GraphType::DistanceField, false},
+    {"jps", GraphType::JumpPoint, false},
+    {"astar", GraphType::AStar, false},
+    {"hpa", GraphType::Hierarchical, false, true},
+    {"grid", GraphType::Specialized, false},
+    {"grid-rt", GraphType::RuntimeGrid, false},
+    {"dial", GraphType::Weighted, false, false, true},
+    {"ll-bi", GraphType::LinkedList, true},
+    {"map-bi", GraphType::Map, true},
+    {"flat-bi", GraphType::Flat, true}
+};
+
+long peakRssKb()
+{
+    /*
+    Returns the peak resident set size of this process, in KB.
+    */
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters;
+    GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters));
+    return counters.PeakWorkingSetSize / 1024;
+#else
+    rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+#endif
+}
+
+bool readScen(const string& path, vector<Scenario>& scenarios, string& firstMap)
+{
+    /*
+    Reads a MovingAI scenario file.  After the "version" line, each line is:
+    bucket map width height startX startY goalX goalY optimalLength
+    x is the column and y is the row.  Queries that do not fit on the board are skipped.  firstMap is set to the map
+    of the first query.
+    */
+    std::ifstream in(path);
+
+    if (!in)
+        return false;
+
+    string line;
+
+    while (std::getline(in, line))
+    {
+        std::istringstream fields(line);
+        int bucket, width, height, startX, startY, goalX, goalY;
+        string mapName;
+
+        if (line.compare(0, 7, "version") == 0 || !(fields >> bucket >> mapName >> width >> height >> startX >> startY >> goalX >> goalY))
+            continue;
+
+        if (firstMap.empty())
+            firstMap = mapName;
+
+        if (startX < tilesX && startY < tilesY && goalX < tilesX && goalY < tilesY)
+            scenarios.push_back({startY * tilesX + startX, goalY * tilesX + goalX});
+    }
+
+    return true;
+}
+
+bool loadScenarioMap(Board& board, const string& scenPath, const string& mapName)
+{
+    /*
+    Loads the obstacle layout of the map named in a scenario file.  Scenario files name their map by a path that is
+    sometimes relative to the scenario file and sometimes only a file name, so the map is looked for next to the
+    scenario file, under both names, and then as named.
+    */
+    size_t slash = scenPath.find_last_of("/\\");
+    string dir = slash == string::npos ? "" : scenPath.substr(0, slash + 1);
+    size_t nameSlash = mapName.find_last_of("/\\");
+    string fileName = nameSlash == string::npos ? mapName : mapName.substr(nameSlash + 1);
+
+    return board.loadObstacleMap(dir + mapName) || board.loadObstacleMap(dir + fileName) || board.loadObstacleMap(mapName);
+}
+
+void writeQueryStats(std::ostream& out, const string& engine, int query, const QueryStats& stats)
+{
+    /*
+    Writes one line of the --stats CSV.
+    */
+    out << engine << "," << query << "," << stats.seekMs << "," << stats.searchMs << "," << stats.reconstructMs << ","
+        << stats.dequeued << "," << stats.edgesScanned << "," << stats.peakQueue << "," << stats.pathLength << ","
+        << stats.cached << "," << stats.cycles << "," << stats.instructions << "," << stats.llcMisses << "," << stats.branchMisses << "\n";
+}
+
+int referenceCost(Board& board, int src, int dest)
+{
+    /*
+    Returns the terrain cost of the cheapest path from src to dest, -1 if there is none, found by Dijkstra's
+    algorithm with a binary heap, independently of the board's engines.  Moves go to any of the 8 neighbors, and
+    entering a tile costs its terrain cost.
+    */
+    vector<int> dist(board.numTiles(), -1);
+    std::priority_queue<pair<int, int>, vector<pair<int, int>>, std::greater<pair<int, int>>> open;
+    dist[src] = 0;
+    open.push({0, src});
+
+    while (!open.empty())
+    {
+        int d = open.top().first;
+        int u = open.top().second;
+        open.pop();
+
+        if (d != dist[u])
+            continue;
+
+        if (u == dest)
+            return d;
+
+        for (int di = -1; di <= 1; di++)
+        {
+            for (int dj = -1; dj <= 1; dj++)
+            {
+                int i = u / tilesX + di;
+                int j = u % tilesX + dj;
+                int v = i * tilesX + j;
+
+                if ((di == 0 && dj == 0) || i < 0 || i >= tilesY || j < 0 || j >= tilesX || board.obstacleAt(v))
+                    continue;
+
+                if (dist[v] == -1 || d + board.terrainAt(v) < dist[v])
+                {
+                    dist[v] = d + board.terrainAt(v);
+                    open.push({dist[v], v});
+                }
+            }
+        }
+    }
+
+    return -1;
+}
+
+double percentile(vector<double> times, double pct)
+{
+    /*
+    Returns the given percentile (0 to 100) of times using the nearest-rank method.
+    */
+    if (times.empty())
+        return 0;
+
+    std::sort(times.begin(), times.end());
+    int rank = std::ceil(pct / 100.0 * times.size());
+    return times[std::max(rank, 1) - 1];
+}
+
+int main(int argc, char** argv)
+{
+    string scenPath;
+    string outPath;
+    unsigned seed = 1;
+    int numQueries = 1000;
+    double density = 0.2;
+    bool json = false;
+    int alpha = 14;
+    int beta = 24;
+    string levelStatsPath;
+    int threads = 0;
+    int connectivity = 8;
+    bool batch = false;
+    int edits = 0;
+    bool cache = false;
+    int perSource = 1;
+    bool setup = false;
+    string snapshotPath;
+    string mapPath;
+    string statsPath;
+    vector<EngineName> engines = engineNames;
+
+    for (int a = 1; a < argc; a++)
+    {
+        string arg = argv[a];
+        bool hasValue = a + 1 < argc;
+
+        if (arg == "--scen" && hasValue)
+            scenPath = argv[++a];
+
+        else if (arg == "--seed" && hasValue)
+            seed = std::strtoul(argv[++a], nullptr, 10);
+
+        else if (arg == "--queries" && hasValue)
+            numQueries = std::atoi(argv[++a]);
+
+        else if (arg == "--density" && hasValue)
+            density = std::atof(argv[++a]);
+
+        else if (arg == "--out" && hasValue)
+            outPath = argv[++a];
+
+        else if (arg == "--alpha" && hasValue)
+            alpha = std::atoi(argv[++a]);
+
+        else if (arg == "--beta" && hasValue)
+            beta = std::atoi(argv[++a]);
+
+        else if (arg == "--level-stats" && hasValue)
+            levelStatsPath = argv[++a];
+
+        else if (arg == "--threads" && hasValue)
+            threads = std::atoi(argv[++a]);
+
+        else if (arg == "--conn" && hasValue)
+            connectivity = std::atoi(argv[++a]);
+
+        else if (arg == "--edits" && hasValue)
+            edits = std::atoi(argv[++a]);
+
+        else if (arg == "--stats" && hasValue)
+            statsPath = argv[++a];
+
+        else if (arg == "--map" && hasValue)
+            mapPath = argv[++a];
+
+        else if (arg == "--snapshot" && hasValue)
+            snapshotPath = argv[++a];
+
+        else if (arg == "--per-source" && hasValue)
+            perSource = std::max(1, std::atoi(argv[++a]));
+
+        else if (arg == "--batch")
+            batch = true;
+
+        else if (arg == "--cache")
+            cache = true;
+
+        else if (arg == "--setup")
+            setup = true;
+
+        else if (arg == "--json")
+            json = true;
+
+        else if (arg == "--engines" && hasValue)
+        {
+            engines.clear();
+            std::istringstream list(argv[++a]);
+            string name;
+
+            while (std::getline(list, name, ','))
+            {
+                auto match = std::find_if(engineNames.begin(), engineNames.end(), [&](const EngineName& e) { return e.name == name; });
+
+                if (match == engineNames.end())
+                {
+                    cerr << "Unknown engine: " << name << "\n";
+                    return 1;
+                }
+
+                engines.push_back(*match);
+            }
+        }
+
+        else
+        {
+            cerr << "Usage: bench [--scen file.scen] [--seed n] [--queries n] [--density d] [--engines ll,map,flat,bits,flat-bi,...] [--json] [--out file] [--alpha n] [--beta n] [--level-stats file] [--threads n] [--batch] [--edits n] [--cache] [--per-source n] [--setup] [--snapshot file] [--map file] [--stats file] [--conn 4|8]\n";
+            return 1;
+        }
+    }
+
+    if (setup)
+    {
+        long long allocationsBefore = allocationCount;
+        auto start = std::chrono::steady_clock::now();
+        Board* scratch = new Board();
+        auto built = std::chrono::steady_clock::now();
+        long long allocations = allocationCount - allocationsBefore;
+        double graphBuild = scratch->setupTime();
+        delete scratch;
+        auto stop = std::chrono::steady_clock::now();
+        cerr << std::fixed << std::setprecision(1) << "Board setup: " << std::chrono::duration<double, std::milli>(built - start).count()
+             << " ms, " << allocations << " allocations; teardown: " << std::chrono::duration<double, std::milli>(stop - built).count() << " ms\n";
+        cerr << "Graph build: " << graphBuild << " ms\n";
+
+        if (!snapshotPath.empty())
+        {
+            // The first board writes the snapshot if there is none yet, so the second is always a load.
+            delete new Board(snapshotPath);
+            allocationsBefore = allocationCount;
+            Board* loaded = new Board(snapshotPath);
+            cerr << "Snapshot load: " << loaded->setupTime() << " ms, " << allocationCount - allocationsBefore << " allocations"
+                 << (loaded->loadedFromSnapshot() ? "" : " (snapshot not valid, built instead)") << "\n";
+            delete loaded;
+        }
+    }
+
+    Board board(snapshotPath);
+    int numVertices = board.numTiles();
+    std::mt19937 rng(seed);
+    vector<Scenario> scenarios;
+    string scenMap;
+
+    if (!scenPath.empty() && !readScen(scenPath, scenarios, scenMap))
+    {
+        cerr << "Could not read " << scenPath << "\n";
+        return 1;
+    }
+
+    // The obstacle layout shared by every query comes from --map, or else from the scenario file's map.
+    bool mapLoaded = false;
+
+    if (!mapPath.empty())
+    {
+        if (!board.loadObstacleMap(mapPath))
+        {
+            cerr << "Could not read " << mapPath << "\n";
+            return 1;
+        }
+
+        mapLoaded = true;
+    }
+
+    else if (!scenMap.empty())
+    {
+        mapLoaded = loadScenarioMap(board, scenPath, scenMap);
+
+        if (!mapLoaded)
+            cerr << "Could not read map " << scenMap << ", using a random obstacle layout\n";
+    }
+
+    // Without a map, the layout is random.
+    vector<int> obstacles;
+    vector<char> isObst(numVertices, 0);
+    std::bernoulli_distribution coin(density);
+
+    for (int u = 0; u < numVertices; u++)
+    {
+        if (mapLoaded ? board.obstacleAt(u) : coin(rng))
+        {
+            obstacles.push_back(u);
+            isObst[u] = 1;
+        }
+    }
+
+    // Without a scenario file, generate random queries between free tiles.
+    if (scenPath.empty())
+    {
+        // Both ends are drawn from the free tiles, and every query needs two different ones.
+        vector<int> freeTiles;
+
+        for (int u = 0; u < numVertices; u++)
+        {
+            if (!isObst[u])
+                freeTiles.push_back(u);
+        }
+
+        if (freeTiles.size() < 2)
+        {
+            cerr << "Fewer than two free tiles, so there are no queries to run\n";
+            return 1;
+        }
+
+        std::uniform_int_distribution<int> pick(0, freeTiles.size() - 1);
+        int src = 0;
+
+        while (scenarios.size() < numQueries)
+        {
+            // A new source starts every perSource queries.
+            if (scenarios.size() % perSource == 0)
+                src = freeTiles[pick(rng)];
+
+            int dest = freeTiles[pick(rng)];
+
+            if (src != dest)
+                scenarios.push_back({src, dest});
+        }
+    }
+
+    board.setObstacles(obstacles);
+    board.setDirectionThresholds(alpha, beta);
+
+    if (threads > 0)
+        board.setThreads(threads);
+
+    board.setGridConnectivity(connectivity);
+
+    board.setCacheEnabled(cache);
+    std::ofstream levelStats;
+
+    if (!levelStatsPath.empty())
+    {
+        levelStats.open(levelStatsPath);
+        levelStats << "query,level,direction,frontier_size,edges_checked\n";
+    }
+
+    std::ofstream queryStats;
+
+    if (!statsPath.empty())
+    {
+        queryStats.open(statsPath);
+        queryStats << std::fixed << std::setprecision(4);
+        queryStats << "engine,query,seek_ms,search_ms,reconstruct_ms,dequeued,edges_scanned,peak_queue,path_length,cached,cycles,instructions,llc_misses,branch_misses\n";
+    }
+
+    vector<EngineResult> results;
+    // Path length found by the first exact engine for each query, so that the other engines can be checked against it.
+    vector<int> expected;
+    // As expected, for the first query of each scenario only.  The batch answers are checked against it.
+    vector<int> expectedScenario;
+    bool mismatch = false;
+    // True if a weighted engine's path cost differed from referenceCost.
+    bool costMismatch = false;
+
+    for (auto& engine: engines)
+    {
+        EngineResult result;
+        result.name = engine.name;
+        // With terrain, the cheapest path may take more moves than the shortest, so a weighted engine's lengths are
+        // checked like an approximate engine's, and its costs are checked against referenceCost instead.
+        bool checkCosts = engine.weighted && !board.flatTerrain();
+        result.approximate = engine.approximate || checkCosts;
+        board.setBidirectional(engine.bidirectional);
+        // Every engine sees the same sequence of edits.
+        std::mt19937 editRng(seed);
+        std::uniform_int_distribution<int> pickTile(0, numVertices - 1);
+        long long hitsBefore = board.cacheHitCount();
+
+        for (int s = 0; s < scenarios.size(); s++)
+        {
+            // Scenarios whose source or destination landed on an obstacle are skipped (by every engine alike).
+            if (!board.setQuery(scenarios[s].src, scenarios[s].dest))
+                continue;
+
+            long long allocationsBefore = allocationCount;
+            int length = board.runQuery(engine.type);
+            result.allocations += allocationCount - allocationsBefore;
+
+            if (checkCosts && board.lastPathCost() != referenceCost(board, scenarios[s].src, scenarios[s].dest))
+                costMismatch = true;
+            result.times.push_back(board.lastDuration());
+
+            if (queryStats.is_open())
+                writeQueryStats(queryStats, engine.name, s, board.lastQueryStats());
+            result.nodesExpanded += board.lastNodesExpanded();
+
+            if (levelStats.is_open() && engine.type == GraphType::DirectionOptimizing)
+            {
+                for (const LevelStats& stats: board.lastLevelStats())
+                    levelStats << s << "," << stats.level << "," << (stats.bottomUp ? "bottom-up" : "top-down") << "," << stats.frontierSize << "," << stats.edgesChecked << "\n";
+            }
+
+            result.lengths.push_back(length);
+            result.scenarioLengths.push_back(length);
+
+            // Toggle single tiles and re-run the same query after each, then put the layout back.
+            vector<int> toggled;
+
+            for (int k = 0; k < edits; k++)
+            {
+                int u = pickTile(editRng);
+
+                if (u == scenarios[s].src || u == scenarios[s].dest)
+                    continue;
+
+                isObst[u] = !isObst[u];
+                board.setObstacleAt(u, isObst[u]);
+                toggled.push_back(u);
+                allocationsBefore = allocationCount;
+                length = board.runQuery(engine.type);
+                result.allocations += allocationCount - allocationsBefore;
+
+                if (checkCosts && board.lastPathCost() != referenceCost(board, scenarios[s].src, scenarios[s].dest))
+                    costMismatch = true;
+
+                if (queryStats.is_open())
+                    writeQueryStats(queryStats, engine.name, s, board.lastQueryStats());
+                result.times.push_back(board.lastDuration());
+                result.nodesExpanded += board.lastNodesExpanded();
+
+                result.lengths.push_back(length);
+            }
+
+            for (int k = toggled.size() - 1; k >= 0; k--)
+            {
+                isObst[toggled[k]] = !isObst[toggled[k]];
+                board.setObstacleAt(toggled[k], isObst[toggled[k]]);
+            }
+
+            // Then run the query once more on the restored layout, as after undoing the edits.  With --cache, the
+            // path found by the first run is still cached for this layout, so no search is needed.
+            if (!toggled.empty())
+            {
+                allocationsBefore = allocationCount;
+                length = board.runQuery(engine.type);
+                result.allocations += allocationCount - allocationsBefore;
+
+                if (checkCosts && board.lastPathCost() != referenceCost(board, scenarios[s].src, scenarios[s].dest))
+                    costMismatch = true;
+
+                if (queryStats.is_open())
+                    writeQueryStats(queryStats, engine.name, s, board.lastQueryStats());
+                result.times.push_back(board.lastDuration());
+                result.nodesExpanded += board.lastNodesExpanded();
+
+                result.lengths.push_back(length);
+            }
+        }
+
+        result.peakRssKb = peakRssKb();
+        result.cacheHits = board.cacheHitCount() - hitsBefore;
+        results.push_back(result);
+    }
+
+    // Check every engine against the first exact one.  Approximate engines must agree on whether a path exists and
+    // may not beat the shortest, but may find longer paths, which are counted instead.
+    for (const EngineResult& result: results)
+    {
+        if (!result.approximate)
+        {
+            expected = result.lengths;
+            expectedScenario = result.scenarioLengths;
+            break;
+        }
+    }
+
+    for (EngineResult& result: results)
+    {
+        for (int q = 0; q < expected.size(); q++)
+        {
+            int length = result.lengths[q];
+
+            if (!result.approximate && length != expected[q])
+                mismatch = true;
+
+            else if (result.approximate && ((length == -1) != (expected[q] == -1) || length < expected[q]))
+                mismatch = true;
+
+            else if (length > expected[q])
+                result.longerPaths++;
+        }
+    }
+
+    if (batch)
+    {
+        // Only scenarios whose endpoints are free are answered, matching the engines above.
+        vector<pair<int, int>> queries;
+
+        for (const Scenario& s: scenarios)
+        {
+            if (board.setQuery(s.src, s.dest))
+                queries.push_back({s.src, s.dest});
+        }
+
+        EngineResult result;
+        result.name = "msbfs";
+
+        // The whole set is handed over at once so the batch interface can group nearby sources.
+        vector<BatchResult> answers = board.shortestPathsBatch(queries);
+        result.nodesExpanded = board.lastNodesExpanded();
+
+        for (int q = 0; q < answers.size(); q++)
+        {
+            result.times.push_back(board.lastDuration() / answers.size());
+
+            if (!expectedScenario.empty() && expectedScenario[q] != answers[q].distance)
+                mismatch = true;
+        }
+
+        result.peakRssKb = peakRssKb();
+        results.push_back(result);
+    }
+
+    if (mismatch)
+        cerr << "Warning: engines disagree on the length of at least one shortest path\n";
+
+    if (costMismatch)
+        cerr << "Warning: the weighted engine's path cost differs from Dijkstra's on at least one query\n";
+
+    std::ofstream file;
+
+    if (!outPath.empty())
+        file.open(outPath);
+
+    std::ostream& out = outPath.empty() ? cout : file;
+    out << std::fixed << std::setprecision(4);
+
+    if (json)
+        out << "[\n";
+
+    else
+        out << "engine,queries,p50_ms,p95_ms,p99_ms,queries_per_s,nodes_expanded_per_query,peak_rss_kb,cache_hits,longer_paths,allocs_per_query\n";
+
+    for (int r = 0; r < results.size(); r++)
+    {
+        const EngineResult& result = results[r];
+        double total = 0;
+
+        for (double t: result.times)
+            total += t;
+
+        int n = result.times.size();
+        double throughput = total > 0 ? n / (total / 1000.0) : 0;
+        double expandedPerQuery = n > 0 ? double(result.nodesExpanded) / n : 0;
+        double allocationsPerQuery = n > 0 ? double(result.allocations) / n : 0;
+
+        if (json)
+        {
+            out << "  {\"engine\": \"" << result.name << "\", \"queries\": " << n
+                << ", \"p50_ms\": " << percentile(result.times, 50)
+                << ", \"p95_ms\": " << percentile(result.times, 95)
+                << ", \"p99_ms\": " << percentile(result.times, 99)
+                << ", \"queries_per_s\": " << throughput
+                << ", \"nodes_expanded_per_query\": " << expandedPerQuery
+                << ", \"peak_rss_kb\": " << result.peakRssKb
+                << ", \"cache_hits\": " << result.cacheHits
+                << ", \"longer_paths\": " << result.longerPaths
+                << ", \"allocs_per_query\": " << allocationsPerQuery << "}"
+                << (r + 1 < results.size() ? ",\n" : "\n");
+        }
+
+        else
+        {
+            out << result.name << "," << n << "," << percentile(result.times, 50) << "," << percentile(result.times, 95) << ","
+                << percentile(result.times, 99) << "," << throughput << "," << expandedPerQuery << "," << result.peakRssKb << ","
+                << result.cacheHits << "," << result.longerPaths << "," << allocationsPerQuery << "\n";
+        }
+    }
+
+    if (json)
+        out << "]\n";
+
+    return mismatch || costMismatch ? 2 : 0;
+}
@@ -4,7 +4,7 @@
 int main()
 {
     // Note: When program runs, a window will open.  Do not resize the window.  Please keep as-is.
-    Board board; // Constructs a board having default values.
+    Board board("board.snapshot"); // Constructs a board having default values, with its graphs loaded from board.snapshot if it exists.
     sf::RenderWindow window(sf::VideoMode(1920, 1080), "FIND SHORTEST PATH VIA BFS!"); // Create a window object.
     board.play(window); // Plays the "game", accepting user input, displaying results, etc.
     return 0;